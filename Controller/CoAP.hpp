@@ -9,26 +9,827 @@
 #define CoAP_hpp
 
 #include <cstdint>
+#include <cstddef>
 #include <cstring>
+#include <cstdio>
+#include <array>
+#include <bit>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <optional>
+#include <stdexcept>
 
+/// Message types
+enum CoAPType: uint8_t
+{
+    kConfirmable    = 0,
+    kNonConfirmable = 1,
+    kAcknowledgement = 2,
+    kReset          = 3,
+};
+
+/// Option numbers
+enum CoAPOption: uint16_t
+{
+    kIfMatch       = 1,
+    kURIHost       = 3,
+    kETag          = 4,
+    kIfNoneMatch   = 5,
+    kObserve       = 6,
+    kURIPort       = 7,
+    kLocationPath  = 8,
+    kURIPath       = 11,
+    kContentFormat = 12,
+    kMaxAge        = 14,
+    kURIQuery      = 15,
+    kAccept        = 17,
+    kLocationQuery = 20,
+    kBlock2        = 23,
+    kBlock1        = 27,
+    kSize2         = 28,
+    kProxyURI      = 35,
+    kProxyScheme   = 39,
+    kSize1         = 60,
+};
+
+/// Compose a message code from its class and detail, such as `CoAPCode(2, 5)` for `2.05 Content`
+constexpr uint8_t CoAPCode(uint8_t cls, uint8_t detail)
+{
+    return static_cast<uint8_t>(cls << 5 | (detail & 0x1F));
+}
+
+/// The order in which the header packs its fields
+enum CoAPHeaderLayout
+{
+    /// The layout defined by RFC 7252: the version in the 2 most significant bits of the first byte followed by the type and the token length,
+    /// and the message identifier in network byte order
+    kStandard,
+
+    /// The layout that compilers for little-endian targets gave the former `CoAPHeader` bitfield struct:
+    /// the version in the 2 least significant bits of the first byte followed by the type and the token length,
+    /// and the message identifier in little-endian byte order
+    /// @note The gateway kernel parses this layout.
+    kLegacy,
+};
+
+/// Reasons for which a buffer is not a well-formed CoAP message
+enum CoAPError
+{
+    /// The buffer ends in the middle of the header, the token or an option
+    kTruncated,
+
+    /// The version is not 1
+    kUnknownVersion,
+
+    /// The token length is greater than 8
+    kInvalidTokenLength,
+
+    /// An empty message has a token, options or a payload
+    kInvalidEmptyMessage,
+
+    /// An option uses the reserved nibble 15 or its number exceeds 65535
+    kInvalidOption,
+
+    /// The payload marker is not followed by any payload
+    kEmptyPayload,
+};
+
+/// The fixed header of a CoAP message
 struct CoAPHeader
 {
-    uint8_t version: 2;
+    /// The number of bytes in the header
+    static constexpr size_t kSize = 4;
+
+    /// The protocol version which is 1
+    uint8_t version = 1;
+
+    /// The message type
+    CoAPType type = kConfirmable;
+
+    /// The number of bytes in the token, from 0 to 8
+    uint8_t tokenLength = 0;
+
+    /// The message code
+    uint8_t code = 0;
+
+    /// The message identifier
+    uint16_t messageID = 0;
+
+    ///
+    /// Encode the header
+    ///
+    /// @param buffer The buffer that holds the encoded header on return
+    /// @param layout The order in which the header packs its fields
+    ///
+    constexpr void encode(std::span<uint8_t, kSize> buffer, CoAPHeaderLayout layout = kStandard) const
+    {
+        if (layout == kStandard)
+        {
+            buffer[0] = static_cast<uint8_t>(this->version << 6 | this->type << 4 | this->tokenLength);
+        }
+        else
+        {
+            buffer[0] = static_cast<uint8_t>(this->version | this->type << 2 | this->tokenLength << 4);
+        }
+
+        buffer[1] = this->code;
+
+        encodeMessageID(buffer.template subspan<2, 2>(), this->messageID, layout);
+    }
+
+    ///
+    /// Encode a message identifier
+    ///
+    /// @param buffer The buffer that holds the encoded message identifier on return
+    /// @param messageID The message identifier
+    /// @param layout The order in which the header packs its fields
+    ///
+    static constexpr void encodeMessageID(std::span<uint8_t, 2> buffer, uint16_t messageID, CoAPHeaderLayout layout = kStandard)
+    {
+        auto high = static_cast<uint8_t>(messageID >> 8), low = static_cast<uint8_t>(messageID);
+
+        buffer[0] = layout == kStandard ? high : low;
+
+        buffer[1] = layout == kStandard ? low : high;
+    }
+
+    ///
+    /// Decode a header
+    ///
+    /// @param buffer The buffer that holds the encoded header
+    /// @param layout The order in which the header packs its fields
+    /// @return The decoded header.
+    /// @note The caller must validate the version and the token length.
+    ///
+    static constexpr CoAPHeader decode(std::span<const uint8_t, kSize> buffer, CoAPHeaderLayout layout = kStandard)
+    {
+        CoAPHeader header;
+
+        if (layout == kStandard)
+        {
+            header.version = buffer[0] >> 6;
+
+            header.type = static_cast<CoAPType>(buffer[0] >> 4 & 0x03);
+
+            header.tokenLength = buffer[0] & 0x0F;
+
+            header.messageID = static_cast<uint16_t>(buffer[2] << 8 | buffer[3]);
+        }
+        else
+        {
+            header.version = buffer[0] & 0x03;
+
+            header.type = static_cast<CoAPType>(buffer[0] >> 2 & 0x03);
+
+            header.tokenLength = buffer[0] >> 4;
+
+            header.messageID = static_cast<uint16_t>(buffer[3] << 8 | buffer[2]);
+        }
+
+        header.code = buffer[1];
+
+        return header;
+    }
+};
+
+/// An option of a decoded CoAP message
+struct CoAPOptionView
+{
+    /// The option number
+    uint16_t number;
+
+    /// The option value which refers to the buffer of the message
+    std::span<const uint8_t> value;
+};
+
+///
+/// Read the delta or the length of an option from its nibble and the extended bytes that follow
+///
+/// @param nibble The nibble in the first byte of the option
+/// @param buffer The remaining bytes of the option
+/// @param offset The offset of the extended bytes in the buffer, which is advanced past them on return
+/// @return The delta or the length on success, `std::nullopt` if the nibble is reserved or the buffer is truncated.
+///
+constexpr std::optional<uint32_t> CoAPDecodeOptionField(uint8_t nibble, std::span<const uint8_t> buffer, size_t& offset)
+{
+    switch (nibble)
+    {
+        case 13:
+            if (offset + 1 > buffer.size())
+            {
+                return std::nullopt;
+            }
+
+            offset += 1;
+
+            return buffer[offset - 1] + 13u;
+
+        case 14:
+            if (offset + 2 > buffer.size())
+            {
+                return std::nullopt;
+            }
+
+            offset += 2;
+
+            return (buffer[offset - 2] << 8 | buffer[offset - 1]) + 269u;
+
+        case 15:
+            return std::nullopt;
+
+        default:
+            return nibble;
+    }
+}
+
+///
+/// A view of a well-formed CoAP message
+///
+/// @note The view refers to the buffer from which the message is decoded and never allocates.
+///
+struct CoAPMessageView
+{
+    /// The fixed header
+    CoAPHeader header;
+
+    /// The token
+    std::span<const uint8_t> token;
+
+    /// The encoded options
+    std::span<const uint8_t> options;
+
+    /// The payload, which is empty if the message does not have the payload marker
+    std::span<const uint8_t> payload;
+
+    /// Iterates over the options of a message that has been validated
+    struct OptionIterator
+    {
+    private:
+        /// The encoded options that follow the current option
+        std::span<const uint8_t> remaining;
+
+        /// The current option
+        CoAPOptionView option;
+
+        /// `true` if the iterator has passed the last option
+        bool exhausted;
+
+        /// Decode the option at the beginning of the remaining bytes
+        constexpr void advance()
+        {
+            if (this->remaining.empty())
+            {
+                this->exhausted = true;
+
+                return;
+            }
+
+            size_t offset = 1;
+
+            uint32_t delta = *CoAPDecodeOptionField(this->remaining[0] >> 4, this->remaining, offset);
+
+            uint32_t length = *CoAPDecodeOptionField(this->remaining[0] & 0x0F, this->remaining, offset);
+
+            this->option = { static_cast<uint16_t>(this->option.number + delta), this->remaining.subspan(offset, length) };
+
+            this->remaining = this->remaining.subspan(offset + length);
+        }
+
+    public:
+        /// Create an iterator to the first of the given options
+        constexpr explicit OptionIterator(std::span<const uint8_t> options) : remaining(options), option{ 0, {} }, exhausted(false)
+        {
+            this->advance();
+        }
+
+        /// Create an iterator past the last option
+        constexpr OptionIterator() : remaining(), option{ 0, {} }, exhausted(true) {}
+
+        constexpr const CoAPOptionView& operator*() const
+        {
+            return this->option;
+        }
+
+        constexpr OptionIterator& operator++()
+        {
+            this->advance();
+
+            return *this;
+        }
+
+        constexpr bool operator==(const OptionIterator& other) const
+        {
+            return this->exhausted == other.exhausted && (this->exhausted || this->remaining.data() == other.remaining.data());
+        }
+    };
+
+    /// Get an iterator to the first option
+    [[nodiscard]]
+    constexpr OptionIterator begin() const
+    {
+        return OptionIterator(this->options);
+    }
+
+    /// Get an iterator past the last option
+    [[nodiscard]]
+    constexpr OptionIterator end() const
+    {
+        return {};
+    }
+
+    ///
+    /// Find the first option that has the given number
+    ///
+    /// @param number The option number
+    /// @return The value of the option on success, `std::nullopt` if the message does not have the option.
+    ///
+    [[nodiscard]]
+    constexpr std::optional<std::span<const uint8_t>> findOption(uint16_t number) const
+    {
+        for (const CoAPOptionView& option : *this)
+        {
+            if (option.number == number)
+            {
+                return option.value;
+            }
+
+            if (option.number > number)
+            {
+                break;
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    ///
+    /// Decode a message
+    ///
+    /// @param buffer The buffer that holds exactly one encoded message
+    /// @param layout The order in which the header packs its fields
+    /// @param error The reason for which the buffer is malformed on return, if not null
+    /// @return A view of the message on success, `std::nullopt` if the buffer is malformed.
+    ///
+    static constexpr std::optional<CoAPMessageView> decode(std::span<const uint8_t> buffer, CoAPHeaderLayout layout = kStandard, CoAPError* error = nullptr)
+    {
+        auto fail = [error](CoAPError reason) -> std::optional<CoAPMessageView>
+        {
+            if (error != nullptr)
+            {
+                *error = reason;
+            }
+
+            return std::nullopt;
+        };
+
+        // Guard: The header and the token must be complete
+        if (buffer.size() < CoAPHeader::kSize)
+        {
+            return fail(kTruncated);
+        }
+
+        CoAPMessageView message = {};
+
+        message.header = CoAPHeader::decode(buffer.first<CoAPHeader::kSize>(), layout);
+
+        if (message.header.version != 1)
+        {
+            return fail(kUnknownVersion);
+        }
+
+        if (message.header.tokenLength > 8)
+        {
+            return fail(kInvalidTokenLength);
+        }
+
+        if (message.header.code == 0 && (message.header.tokenLength != 0 || buffer.size() != CoAPHeader::kSize))
+        {
+            return fail(kInvalidEmptyMessage);
+        }
+
+        if (buffer.size() < CoAPHeader::kSize + message.header.tokenLength)
+        {
+            return fail(kTruncated);
+        }
+
+        message.token = buffer.subspan(CoAPHeader::kSize, message.header.tokenLength);
+
+        // Validate the options up to the payload marker
+        size_t start = CoAPHeader::kSize + message.header.tokenLength, offset = start;
+
+        uint32_t number = 0;
+
+        while (offset < buffer.size() && buffer[offset] != 0xFF)
+        {
+            uint8_t first = buffer[offset];
+
+            offset += 1;
+
+            auto delta = CoAPDecodeOptionField(first >> 4, buffer, offset);
+
+            auto length = delta ? CoAPDecodeOptionField(first & 0x0F, buffer, offset) : std::nullopt;
+
+            if (!delta || !length)
+            {
+                return fail((first >> 4) == 15 || (first & 0x0F) == 15 ? kInvalidOption : kTruncated);
+            }
+
+            number += *delta;
+
+            if (number > UINT16_MAX)
+            {
+                return fail(kInvalidOption);
+            }
+
+            if (*length > buffer.size() - offset)
+            {
+                return fail(kTruncated);
+            }
+
+            offset += *length;
+        }
+
+        message.options = buffer.subspan(start, offset - start);
+
+        // The payload marker must be followed by a non-empty payload
+        if (offset < buffer.size())
+        {
+            if (offset + 1 == buffer.size())
+            {
+                return fail(kEmptyPayload);
+            }
+
+            message.payload = buffer.subspan(offset + 1);
+        }
+
+        return message;
+    }
+};
+
+///
+/// Encodes a CoAP message into a caller-provided buffer
+///
+/// @note The encoder never allocates. Once a field does not fit in the buffer or is invalid, the encoder fails and ignores further fields.
+///       Options must be added in the ascending order of their numbers.
+///
+struct CoAPEncoder
+{
+private:
+    /// The buffer that holds the encoded message
+    std::span<uint8_t> buffer;
+
+    /// The number of bytes encoded so far
+    size_t size;
+
+    /// The number of the last option
+    uint16_t lastOption;
+
+    /// `true` if the message is well-formed so far
+    bool valid;
+
+    /// `true` if the payload has been added
+    bool finished;
+
+    /// The order in which the header packs its fields
+    CoAPHeaderLayout layout;
+
+    /// Append the given bytes
+    constexpr void append(std::span<const uint8_t> data)
+    {
+        if (!this->valid || data.size() > this->buffer.size() - this->size)
+        {
+            this->valid = false;
+
+            return;
+        }
+
+        for (uint8_t byte : data)
+        {
+            this->buffer[this->size++] = byte;
+        }
+    }
+
+    /// Encode the delta or the length of an option as a nibble and the extended bytes that follow the first byte of the option
+    static constexpr uint8_t encodeOptionField(uint32_t value, uint8_t (&extended)[2], size_t& count)
+    {
+        if (value < 13)
+        {
+            count = 0;
+
+            return static_cast<uint8_t>(value);
+        }
+
+        if (value < 269)
+        {
+            extended[0] = static_cast<uint8_t>(value - 13);
 
-    uint8_t type: 2;
+            count = 1;
 
-    uint8_t tokenLength: 4;
+            return 13;
+        }
 
-    uint8_t code;
+        extended[0] = static_cast<uint8_t>((value - 269) >> 8);
+
+        extended[1] = static_cast<uint8_t>(value - 269);
+
+        count = 2;
+
+        return 14;
+    }
+
+    /// Append the first byte of an option along with the extended delta and length
+    constexpr void appendOptionHeader(uint16_t number, size_t length)
+    {
+        if (this->finished || number < this->lastOption || length > 65535 + 269)
+        {
+            this->valid = false;
+
+            return;
+        }
+
+        uint8_t deltaBytes[2] = {}, lengthBytes[2] = {};
+
+        size_t deltaCount = 0, lengthCount = 0;
+
+        uint8_t first = static_cast<uint8_t>(encodeOptionField(number - this->lastOption, deltaBytes, deltaCount) << 4 |
+                                             encodeOptionField(static_cast<uint32_t>(length), lengthBytes, lengthCount));
+
+        this->append(std::span<const uint8_t>(&first, 1));
+
+        this->append(std::span<const uint8_t>(deltaBytes, deltaCount));
+
+        this->append(std::span<const uint8_t>(lengthBytes, lengthCount));
+
+        this->lastOption = number;
+    }
+
+public:
+    ///
+    /// Start to encode a message with the given header and token
+    ///
+    /// @param buffer The buffer that holds the encoded message
+    /// @param type The message type
+    /// @param code The message code
+    /// @param messageID The message identifier
+    /// @param token The token of up to 8 bytes
+    /// @param layout The order in which the header packs its fields
+    ///
+    constexpr CoAPEncoder(std::span<uint8_t> buffer, CoAPType type, uint8_t code, uint16_t messageID, std::span<const uint8_t> token = {}, CoAPHeaderLayout layout = kStandard)
+        : buffer(buffer), size(0), lastOption(0), valid(token.size() <= 8), finished(false), layout(layout)
+    {
+        uint8_t header[CoAPHeader::kSize] = {};
+
+        CoAPHeader{ 1, type, static_cast<uint8_t>(token.size()), code, messageID }.encode(header, layout);
+
+        this->append(header);
+
+        this->append(token);
+    }
+
+    ///
+    /// Add an option
+    ///
+    /// @param number The option number which must not be smaller than that of the previous option
+    /// @param value The option value
+    /// @return `true` if the message is well-formed so far, `false` otherwise.
+    ///
+    constexpr bool addOption(uint16_t number, std::span<const uint8_t> value)
+    {
+        this->appendOptionHeader(number, value.size());
+
+        this->append(value);
+
+        return this->valid;
+    }
+
+    ///
+    /// Add an option whose value is a string
+    ///
+    /// @param number The option number which must not be smaller than that of the previous option
+    /// @param value The option value
+    /// @return `true` if the message is well-formed so far, `false` otherwise.
+    ///
+    constexpr bool addOption(uint16_t number, std::string_view value)
+    {
+        this->appendOptionHeader(number, value.size());
 
-    uint16_t msgID;
+        // A span of bytes cannot view the characters of a string in a constant expression
+        for (char character : value)
+        {
+            auto byte = static_cast<uint8_t>(character);
+
+            this->append(std::span<const uint8_t>(&byte, 1));
+        }
+
+        return this->valid;
+    }
+
+    ///
+    /// Add an option whose value is an unsigned integer in the minimal number of bytes
+    ///
+    /// @param number The option number which must not be smaller than that of the previous option
+    /// @param value The option value
+    /// @return `true` if the message is well-formed so far, `false` otherwise.
+    ///
+    constexpr bool addOption(uint16_t number, uint32_t value)
+    {
+        uint8_t bytes[4] = { static_cast<uint8_t>(value >> 24), static_cast<uint8_t>(value >> 16), static_cast<uint8_t>(value >> 8), static_cast<uint8_t>(value) };
+
+        size_t skipped = value == 0 ? 4 : static_cast<size_t>(std::countl_zero(value) / 8);
+
+        return this->addOption(number, std::span<const uint8_t>(bytes + skipped, 4 - skipped));
+    }
+
+    ///
+    /// Add the payload marker followed by the payload
+    ///
+    /// @param payload The payload, which is omitted along with the marker if it is empty
+    /// @return `true` if the message is well-formed, `false` otherwise.
+    /// @note No option can be added once the payload is added.
+    ///
+    constexpr bool setPayload(std::span<const uint8_t> payload)
+    {
+        if (this->finished)
+        {
+            this->valid = false;
+
+            return false;
+        }
+
+        this->finished = true;
+
+        if (!payload.empty())
+        {
+            uint8_t marker = 0xFF;
+
+            this->append(std::span<const uint8_t>(&marker, 1));
+
+            this->append(payload);
+        }
+
+        return this->valid;
+    }
+
+    ///
+    /// Get the encoded message
+    ///
+    /// @return The bytes of the message on success, `std::nullopt` if a field does not fit in the buffer or is invalid.
+    ///
+    [[nodiscard]]
+    constexpr std::optional<std::span<uint8_t>> getMessage() const
+    {
+        if (!this->valid)
+        {
+            return std::nullopt;
+        }
+
+        return this->buffer.first(this->size);
+    }
+
+    ///
+    /// Get the number of bytes encoded so far
+    ///
+    /// @return The number of bytes.
+    ///
+    [[nodiscard]]
+    constexpr size_t getSize() const
+    {
+        return this->size;
+    }
 };
 
-enum CoAPOption
+///
+/// A CoAP request serialized once, of which only the message identifier, the token and the payload change from one request to the next
+///
+/// @tparam Capacity Specify the maximum number of bytes in a request
+/// @note The header, the options and the payload marker are serialized when the template is created,
+///       which happens at compile time if the template is a `constexpr` variable.
+///       Each request is then a copy of the template with the message identifier, the token and the payload patched in.
+///
+template <size_t Capacity>
+struct CoAPRequestTemplate
 {
-    kURIHost = 3,
-    kURIPort = 7,
-    kURIPath = 11,
+private:
+    /// The serialized request with a zero message identifier, token and payload
+    std::array<uint8_t, Capacity> bytes = {};
+
+    /// The number of bytes in a request
+    size_t size = 0;
+
+    /// The number of bytes in the token
+    size_t tokenLength;
+
+    /// The offset of the payload
+    size_t payloadOffset = 0;
+
+    /// The number of bytes in the payload
+    size_t payloadLength;
+
+    /// The order in which the header packs its fields
+    CoAPHeaderLayout layout;
+
+public:
+    ///
+    /// Serialize a request to the given resource
+    ///
+    /// @param type The message type
+    /// @param code The request method code
+    /// @param host The host name copied to the `Uri-Host` option
+    /// @param port The port number copied to the `Uri-Port` option
+    /// @param path The path copied verbatim to a single `Uri-Path` option
+    /// @param tokenLength The number of bytes in the token of each request, from 0 to 8
+    /// @param payloadLength The number of bytes in the payload of each request, or 0 to omit the payload marker
+    /// @param layout The order in which the header packs its fields
+    /// @throws std::invalid_argument if the token is too long.
+    /// @throws std::length_error if the request exceeds the capacity of the template.
+    ///
+    constexpr CoAPRequestTemplate(CoAPType type, uint8_t code, std::string_view host, uint16_t port, std::string_view path,
+                                  size_t tokenLength, size_t payloadLength, CoAPHeaderLayout layout = kStandard)
+        : tokenLength(tokenLength), payloadLength(payloadLength), layout(layout)
+    {
+        if (tokenLength > 8)
+        {
+            throw std::invalid_argument("The CoAP token is longer than 8 bytes.");
+        }
+
+        if (payloadLength > Capacity)
+        {
+            throw std::length_error("The CoAP request exceeds the capacity of the template.");
+        }
+
+        std::array<uint8_t, 8> token = {};
+
+        std::array<uint8_t, Capacity> payload = {};
+
+        CoAPEncoder encoder(this->bytes, type, code, 0, std::span<const uint8_t>(token.data(), tokenLength), layout);
+
+        encoder.addOption(kURIHost, host);
+
+        encoder.addOption(kURIPort, uint32_t{port});
+
+        encoder.addOption(kURIPath, path);
+
+        encoder.setPayload(std::span<const uint8_t>(payload.data(), payloadLength));
+
+        auto message = encoder.getMessage();
+
+        if (!message)
+        {
+            throw std::length_error("The CoAP request exceeds the capacity of the template.");
+        }
+
+        this->size = message->size();
+
+        this->payloadOffset = this->size - payloadLength;
+    }
+
+    ///
+    /// Get the number of bytes in a request
+    ///
+    /// @return The request size.
+    ///
+    [[nodiscard]]
+    constexpr size_t getSize() const
+    {
+        return this->size;
+    }
+
+    ///
+    /// Get the number of bytes in the payload of a request
+    ///
+    /// @return The payload size.
+    ///
+    [[nodiscard]]
+    constexpr size_t getPayloadLength() const
+    {
+        return this->payloadLength;
+    }
+
+    ///
+    /// Create a request from the template
+    ///
+    /// @param buffer A non-null buffer that holds at least `getSize()` bytes
+    /// @param messageID The message identifier
+    /// @param token A non-null buffer that holds the token if the token is not empty
+    /// @param payload A non-null buffer that holds the payload if the payload is not empty
+    ///
+    void instantiate(uint8_t* buffer, uint16_t messageID, const void* token, const void* payload) const
+    {
+        memcpy(buffer, this->bytes.data(), this->size);
+
+        CoAPHeader::encodeMessageID(std::span<uint8_t, 2>(buffer + 2, 2), messageID, this->layout);
+
+        if (this->tokenLength != 0)
+        {
+            memcpy(buffer + CoAPHeader::kSize, token, this->tokenLength);
+        }
+
+        if (this->payloadLength != 0)
+        {
+            memcpy(buffer + this->payloadOffset, payload, this->payloadLength);
+        }
+    }
 };
 
 enum HTTPMethod
@@ -38,7 +839,7 @@ enum HTTPMethod
     kPut = 3
 };
 
-const char* HTTPMethod2String(enum HTTPMethod method)
+static inline const char* HTTPMethod2String(enum HTTPMethod method)
 {
     switch (method)
     {
@@ -0,0 +1,292 @@
+//
+//  Connector.hpp
+//  Controller
+//
+//  Created by FireWolf on 10/15/26.
+//
+
+#ifndef Connector_hpp
+#define Connector_hpp
+
+#include "Endpoint.hpp"
+#include "StreamSocket.hpp"
+#include <poll.h>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <optional>
+#include <algorithm>
+
+///
+/// Connects to a set of endpoints and receives the preamble from each device concurrently
+///
+/// @note A single thread drives every connection with non-blocking sockets and `poll(2)`,
+///       so the time to get all devices ready is bounded by the slowest device rather than the sum of all devices.
+///       Each endpoint has its own deadline which covers both the connection and the preamble.
+///
+struct Connector
+{
+public:
+    /// The number of garbage bytes that the ARM FastModels sends at the beginning of each connection
+    static constexpr size_t kPreambleLength = 15;
+
+    /// The progress of a connection
+    enum Stage
+    {
+        /// The connection is initiated but not yet established
+        kConnecting,
+
+        /// The connection is established and the preamble is being received
+        kHandshaking,
+
+        /// The connection is established and the preamble has been received
+        kReady,
+
+        /// The connection cannot be established
+        kFailed,
+
+        /// The connection is established but the preamble cannot be received in full
+        kIncomplete,
+    };
+
+    /// The result of connecting to an endpoint
+    struct Attempt
+    {
+        /// The progress of the connection
+        Stage stage = kConnecting;
+
+        /// A blocking socket connected to the endpoint, unless the stage is `kFailed`
+        std::optional<StreamSocket> socket = std::nullopt;
+
+        /// A message that describes the failure if the stage is `kFailed` or a reason without the trailing period if the stage is `kIncomplete`
+        std::string error = {};
+
+        /// The amount of time from the start until the connection is established
+        std::chrono::nanoseconds connectTime = {};
+
+        /// The amount of time from the start until the preamble is received
+        std::chrono::nanoseconds readyTime = {};
+
+        /// The number of preamble bytes received so far
+        size_t received = 0;
+
+        /// The point in time after which the attempt is abandoned
+        std::chrono::steady_clock::time_point deadline = {};
+
+        /// Check whether the attempt is still in progress
+        [[nodiscard]]
+        bool isPending() const
+        {
+            return this->stage == kConnecting || this->stage == kHandshaking;
+        }
+    };
+
+private:
+    ///
+    /// Receive the rest of the preamble that is available on the given attempt without blocking
+    ///
+    /// @param attempt An attempt that is receiving the preamble
+    /// @param elapsed The amount of time since the start
+    ///
+    static void handshake(Attempt& attempt, std::chrono::nanoseconds elapsed)
+    {
+        uint8_t buffer[kPreambleLength] = {};
+
+        size_t length = kPreambleLength - attempt.received;
+
+        ssize_t result = read(attempt.socket->getDescriptor(), buffer, length);
+
+        if (result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+        {
+            return;
+        }
+
+        if (result <= 0)
+        {
+            attempt.stage = kIncomplete;
+
+            attempt.error = result == 0 ? "The device closed the connection" : strerror(errno);
+
+            return;
+        }
+
+        attempt.received += static_cast<size_t>(result);
+
+        if (attempt.received == kPreambleLength)
+        {
+            attempt.stage = kReady;
+
+            attempt.readyTime = elapsed;
+        }
+    }
+
+    ///
+    /// Abandon the given attempt because its deadline has passed
+    ///
+    /// @param attempt An attempt that is still in progress
+    /// @param endpoint The endpoint of the attempt
+    ///
+    static void expire(Attempt& attempt, const Endpoint& endpoint)
+    {
+        if (attempt.stage == kConnecting)
+        {
+            attempt.stage = kFailed;
+
+            attempt.error = fmt::format("Timed out while connecting to {}.", endpoint.description());
+
+            attempt.socket.reset();
+        }
+        else
+        {
+            attempt.stage = kIncomplete;
+
+            attempt.error = fmt::format("Timed out after receiving {} of {} bytes", attempt.received, kPreambleLength);
+        }
+    }
+
+public:
+    ///
+    /// Connect to the given endpoints and receive the preamble from each device
+    ///
+    /// @param endpoints The endpoints to connect to
+    /// @return The result of connecting to each endpoint in the same order as the given endpoints.
+    /// @note The function returns once every attempt is ready, has failed or has passed its deadline.
+    ///       Sockets of attempts that are not `kFailed` are switched back to the blocking mode.
+    ///
+    static std::vector<Attempt> connect(const std::vector<Endpoint>& endpoints)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        auto start = Clock::now();
+
+        std::vector<Attempt> attempts(endpoints.size());
+
+        // Initiate all connections
+        for (size_t index = 0; index < endpoints.size(); index += 1)
+        {
+            Attempt& attempt = attempts[index];
+
+            attempt.deadline = start + endpoints[index].timeout;
+
+            try
+            {
+                attempt.socket.emplace(endpoints[index].connect(false));
+            }
+            catch (SocketException& exception)
+            {
+                attempt.stage = kFailed;
+
+                attempt.error = exception.what();
+            }
+        }
+
+        // Wait for the pending attempts to make progress
+        std::vector<pollfd> descriptors;
+
+        std::vector<size_t> indices;
+
+        while (true)
+        {
+            descriptors.clear();
+
+            indices.clear();
+
+            auto deadline = Clock::time_point::max();
+
+            for (size_t index = 0; index < attempts.size(); index += 1)
+            {
+                const Attempt& attempt = attempts[index];
+
+                if (!attempt.isPending())
+                {
+                    continue;
+                }
+
+                short events = attempt.stage == kConnecting ? POLLOUT : POLLIN;
+
+                descriptors.push_back({ .fd = attempt.socket->getDescriptor(), .events = events, .revents = 0 });
+
+                indices.push_back(index);
+
+                deadline = std::min(deadline, attempt.deadline);
+            }
+
+            // Guard: All attempts have completed
+            if (descriptors.empty())
+            {
+                break;
+            }
+
+            auto remaining = std::chrono::ceil<std::chrono::milliseconds>(deadline - Clock::now());
+
+            int result = poll(descriptors.data(), descriptors.size(), static_cast<int>(std::max<int64_t>(remaining.count(), 0)));
+
+            if (result < 0 && errno != EINTR)
+            {
+                for (size_t index : indices)
+                {
+                    attempts[index].stage = kFailed;
+
+                    attempts[index].error = fmt::format("Failed to wait for the connection. Reason: {}.", strerror(errno));
+
+                    attempts[index].socket.reset();
+                }
+
+                break;
+            }
+
+            auto now = Clock::now();
+
+            for (size_t position = 0; position < descriptors.size(); position += 1)
+            {
+                Attempt& attempt = attempts[indices[position]];
+
+                if (descriptors[position].revents != 0 && attempt.stage == kConnecting)
+                {
+                    int error = attempt.socket->getPendingError();
+
+                    if (error != 0)
+                    {
+                        attempt.stage = kFailed;
+
+                        attempt.error = fmt::format("Failed to connect to {}. Reason: {}.", endpoints[indices[position]].description(), strerror(error));
+
+                        attempt.socket.reset();
+
+                        continue;
+                    }
+
+                    attempt.stage = kHandshaking;
+
+                    attempt.connectTime = now - start;
+                }
+                else if (descriptors[position].revents != 0 && attempt.stage == kHandshaking)
+                {
+                    handshake(attempt, now - start);
+                }
+
+                if (attempt.isPending() && now >= attempt.deadline)
+                {
+                    expire(attempt, endpoints[indices[position]]);
+                }
+            }
+        }
+
+        // Restore the blocking mode expected by the controller
+        for (Attempt& attempt : attempts)
+        {
+            if (attempt.socket && !attempt.socket->setBlocking(true))
+            {
+                attempt.stage = kFailed;
+
+                attempt.error = fmt::format("Failed to restore the blocking mode. Reason: {}.", strerror(errno));
+
+                attempt.socket.reset();
+            }
+        }
+
+        return attempts;
+    }
+};
+
+#endif /* Connector_hpp */
@@ -13,6 +13,20 @@
 #include "Debug.hpp"
 #include "CoAP.hpp"
 #include <iostream>
+#include <cinttypes>
+#include <random>
+#include <bit>
+
+#if defined(__linux__)
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+#if defined(__SSE2__)
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON)
+    #include <arm_neon.h>
+#endif
 
 ///
 /// Split the given string into an array of tokens
@@ -57,373 +71,2571 @@ static std::string trim(const std::string& string, const std::string& whitespace
 {
     auto start = string.find_first_not_of(whitespaces);
 
-    if (start == std::string::npos)
+    if (start == std::string::npos)
+    {
+        return "";
+    }
+
+    auto end = string.find_last_not_of(whitespaces);
+
+    return string.substr(start, end - start + 1);
+}
+
+///
+/// Parse the amount of time specified by the user
+///
+/// @param string A non-negative integer followed by an optional unit, `ms` (default), `s` or `m`, such as `200ms` or `5s`
+/// @return The amount of time on success, `std::nullopt` if the given string is malformed.
+///
+static std::optional<std::chrono::milliseconds> parseDuration(const std::string& string)
+{
+    char* end = nullptr;
+
+    unsigned long long value = strtoull(string.c_str(), &end, 10);
+
+    if (end == string.c_str() || !isdigit(string.front()) || value > UINT32_MAX)
+    {
+        return std::nullopt;
+    }
+
+    std::string unit = end;
+
+    if (unit.empty() || unit == "ms")
+    {
+        return std::chrono::milliseconds(value);
+    }
+
+    if (unit == "s")
+    {
+        return std::chrono::seconds(value);
+    }
+
+    if (unit == "m")
+    {
+        return std::chrono::minutes(value);
+    }
+
+    return std::nullopt;
+}
+
+///
+/// Parse the point in time specified by the user
+///
+/// @param string `+` followed by an amount of time accepted by `parseDuration()`, such as `+5s`,
+///               or the local time of day in the format of `HH:MM:SS`, which refers to tomorrow if it has passed today
+/// @return The point in time on the steady clock on success, `std::nullopt` if the given string is malformed.
+///
+static std::optional<std::chrono::steady_clock::time_point> parseTimePoint(const std::string& string)
+{
+    if (string.starts_with("+"))
+    {
+        auto delay = parseDuration(string.substr(1));
+
+        if (!delay)
+        {
+            return std::nullopt;
+        }
+
+        return std::chrono::steady_clock::now() + *delay;
+    }
+
+    int hour = 0, minute = 0, second = 0, length = 0;
+
+    if (sscanf(string.c_str(), "%2d:%2d:%2d%n", &hour, &minute, &second, &length) != 3 || length != static_cast<int>(string.size()) ||
+        hour > 23 || minute > 59 || second > 59)
+    {
+        return std::nullopt;
+    }
+
+    time_t now = time(nullptr);
+
+    struct tm target = {};
+
+    localtime_r(&now, &target);
+
+    target.tm_hour = hour;
+
+    target.tm_min = minute;
+
+    target.tm_sec = second;
+
+    target.tm_isdst = -1;
+
+    time_t deadline = mktime(&target);
+
+    if (deadline <= now)
+    {
+        target.tm_mday += 1;
+
+        target.tm_isdst = -1;
+
+        deadline = mktime(&target);
+    }
+
+    // Convert the wall clock time to the steady clock, so that adjustments to the wall clock do not move the timer
+    auto remaining = std::chrono::system_clock::from_time_t(deadline) - std::chrono::system_clock::now();
+
+    return std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(remaining);
+}
+
+/// The host, the port and the path to which the moisture level is reported
+static constexpr const char* kMoistureHost = "localhost";
+
+static constexpr uint16_t kMoisturePort = 10086;
+
+static constexpr const char* kMoisturePath = "/moisture";
+
+/// The CoAP request that reports the moisture level to the gateway device, serialized at compile time
+/// @note The gateway kernel parses the legacy header layout.
+static constexpr CoAPRequestTemplate<32> kMoistureRequest(kNonConfirmable, kPost, kMoistureHost, kMoisturePort, kMoisturePath, 0, sizeof(uint32_t), kLegacy);
+
+static_assert(kMoistureRequest.getSize() == 32, "Check the request size.");
+
+///
+/// Create a reader for the translated HTTP request messages sent by the gateway device
+///
+/// @return A reader that treats the bytes after the headers as the payload of the CoAP request message.
+/// @note The gateway appends the payload to the headers without the `Content-Length` header.
+///
+static Controller::GatewayReader makeGatewayReader()
+{
+    return Controller::GatewayReader(kMoistureRequest.getPayloadLength());
+}
+
+///
+/// Receive translated HTTP request messages from the gateway device and pass each complete one to the given handler
+///
+/// @param socket The socket connected to the gateway device
+/// @param reader The reader that keeps the partial message between calls
+/// @param handler A callable object that takes a view of each complete message
+/// @note The caller remains blocked until some data is received.
+///       The controller aborts if it fails to receive data or the gateway device sends a malformed message.
+///
+template <typename Handler>
+static void receiveHTTPRequests(const StreamSocket& socket, Controller::GatewayReader& reader, Handler&& handler)
+{
+    passert(reader.receive(socket), "Failed to receive the HTTP messages.");
+
+    while (auto request = reader.next())
+    {
+        handler(*request);
+    }
+
+    passert(!reader.getError(), "Received a malformed HTTP message. Reason: %s.", HTTPParseError2String(*reader.getError()));
+}
+
+///
+/// Get the tag that a translated HTTP request message carries as its payload
+///
+/// @param request A view of the message
+/// @return The tag, or `UINT32_MAX` if the message does not carry a tag.
+///
+static uint32_t getHTTPRequestTag(const HTTPRequestView& request)
+{
+    uint32_t tag = UINT32_MAX;
+
+    if (request.body.size() == sizeof(tag))
+    {
+        memcpy(&tag, request.body.data(), sizeof(tag));
+    }
+
+    return tag;
+}
+
+///
+/// Find the first byte at which two buffers differ
+///
+/// @param lhs A buffer
+/// @param rhs Another buffer
+/// @return The offset of the first byte that differs, the size of the shorter buffer if it is a prefix of the longer one,
+///         or `std::nullopt` if both buffers are identical.
+/// @note The buffers are compared 16 bytes at a time with SSE2 or NEON, where the first differing byte is located in the byte mask of the comparison.
+///       The remaining bytes, or all bytes on other processors, are compared 8 bytes at a time and located in the XOR of the two words.
+///
+static std::optional<size_t> findFirstMismatch(std::string_view lhs, std::string_view rhs)
+{
+    size_t length = std::min(lhs.size(), rhs.size()), offset = 0;
+
+#if defined(__SSE2__)
+    for (; offset + sizeof(__m128i) <= length; offset += sizeof(__m128i))
+    {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs.data() + offset));
+
+        __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs.data() + offset));
+
+        // Bit i is set if byte i differs
+        auto difference = static_cast<uint32_t>(~_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) & 0xFFFF);
+
+        if (difference != 0)
+        {
+            return offset + static_cast<size_t>(std::countr_zero(difference));
+        }
+    }
+#elif defined(__ARM_NEON) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    for (; offset + sizeof(uint8x16_t) <= length; offset += sizeof(uint8x16_t))
+    {
+        uint8x16_t x = vld1q_u8(reinterpret_cast<const uint8_t*>(lhs.data() + offset));
+
+        uint8x16_t y = vld1q_u8(reinterpret_cast<const uint8_t*>(rhs.data() + offset));
+
+        // Nibble i is set if byte i differs, since NEON does not have a byte mask instruction
+        uint64_t difference = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(vmvnq_u8(vceqq_u8(x, y))), 4)), 0);
+
+        if (difference != 0)
+        {
+            return offset + static_cast<size_t>(std::countr_zero(difference)) / 4;
+        }
+    }
+#endif
+
+    for (; offset + sizeof(uint64_t) <= length; offset += sizeof(uint64_t))
+    {
+        uint64_t x, y;
+
+        memcpy(&x, lhs.data() + offset, sizeof(x));
+
+        memcpy(&y, rhs.data() + offset, sizeof(y));
+
+        if (uint64_t difference = x ^ y; difference != 0)
+        {
+            int bits = std::endian::native == std::endian::little ? std::countr_zero(difference) : std::countl_zero(difference);
+
+            return offset + static_cast<size_t>(bits) / 8;
+        }
+    }
+
+    for (; offset < length; offset += 1)
+    {
+        if (lhs[offset] != rhs[offset])
+        {
+            return offset;
+        }
+    }
+
+    if (lhs.size() != rhs.size())
+    {
+        return length;
+    }
+
+    return std::nullopt;
+}
+
+///
+/// Add a device to the controller
+///
+/// @param role The role of the device
+/// @param endpoint The endpoint at which the controller reconnects to the device
+/// @param socket A socket connected to the device from which the preamble has been received
+/// @param deviceOptions Options that tune how the controller receives messages from the device
+/// @return The identifier of the device on success, `std::nullopt` if the controller cannot accept more devices.
+/// @note Devices must be added before the controller runs.
+///
+std::optional<DeviceID> Controller::addDevice(Role role, const Endpoint& endpoint, StreamSocket socket, DeviceOptions deviceOptions)
+{
+    Device* device = this->devices.add(role, endpoint, std::move(socket), deviceOptions, this->options.lanes, std::nullopt, this->routingTable);
+
+    if (device == nullptr)
+    {
+        return std::nullopt;
+    }
+
+    return device->identifier;
+}
+
+///
+/// Accept connections from devices on the given endpoint
+///
+/// @param role The role of each accepted device, or `std::nullopt` if each device identifies itself with its first message
+/// @param endpoint The address on which to listen and the options applied to each accepted device
+/// @throws SocketException if failed to listen on the given endpoint.
+/// @note Listeners must be added before the controller runs.
+///
+void Controller::addListener(std::optional<Role> role, const Endpoint& endpoint)
+{
+    this->listeners.push_back({ endpoint.listen(), endpoint, role });
+}
+
+//
+// MARK: - Routing
+//
+
+///
+/// Status formats indexed by message types
+///
+/// @note Each format takes the name of the source device and the message data.
+///
+static constexpr const char* kStatusFormats[] =
+{
+    "%s device reports that the shared user stack starts at 0x%08x.",
+    "%s device reports that the shared user stack starts at 0x%08x.",
+    "%s device reports that a thread stack starts at 0x%08x.",
+    "The controller has received a Change Soil Moisture message from the %s device.\n",
+    "The controller has received a Change Water Status message from the %s device.\n",
+    "The controller has received a Soil Dry Alert message from the %s device.\n",
+    "The controller has received a Soil Wet Alert message from the %s device.\n",
+    "The controller has received a Ack Soil Wet message from the %s device.\n",
+    "The controller has received a Run Out Of Water Alert message from the %s device.\n",
+};
+
+static_assert(std::size(kStatusFormats) == Controller::Router::kTypeCount, "Each message type must have a status format.");
+
+///
+/// Create the routing table that relays alerts from monitor devices to actuator devices and acknowledgements back
+///
+/// @return The default routing table.
+///
+Controller::Router Controller::makeDefaultRoutingTable()
+{
+    using Selector = Router::Selector;
+
+    static const Selector kAny = { Selector::kAny, 0 };
+
+    Router table;
+
+    // Messages that are only printed
+    table.add(kAny, Message::Type::kMoistureUserStack);
+
+    table.add(kAny, Message::Type::kActuatorUserStack);
+
+    table.add(kAny, Message::Type::kGateWayUserStack);
+
+    table.add(kAny, Message::Type::kRunOutOfWaterAlert);
+
+    // Messages that are relayed
+    table.add(kAny, Message::Type::kSoilDryAlert, { { Selector::kRole, Role::kActuator } });
+
+    table.add(kAny, Message::Type::kSoilWetAlert, { { Selector::kRole, Role::kActuator } });
+
+    table.add(kAny, Message::Type::kAckSoilWet, { { Selector::kRole, Role::kMonitor } });
+
+    return table;
+}
+
+///
+/// Print the routing decisions for each device
+///
+void Controller::printRoutes() const
+{
+    this->devices.forEach([&](const Device& device) -> void
+    {
+        for (size_t type = 0; type < Router::kTypeCount; type += 1)
+        {
+            const Router::Route& route = device.routes[type];
+
+            if (!route.accepted)
+            {
+                continue;
+            }
+
+            printf("%s: %s ->", device.name.c_str(), Message::Type2String(static_cast<Message::Type>(type)));
+
+            bool relayed = false;
+
+            Router::forEachDestination(route, this->devices, device.identifier, [&](const Device& destination) -> void
+            {
+                printf(" %s", destination.name.c_str());
+
+                relayed = true;
+            });
+
+            printf(relayed ? "\n" : " (printed only)\n");
+        }
+    });
+}
+
+//
+// MARK: - Background Threads
+//
+
+///
+/// The sender thread implementation
+///
+/// @param device The device to which the thread sends messages
+///
+void Controller::sender(Device& device)
+{
+    if (this->options.transport == Transport::kIOURing)
+    {
+        this->senderWithIOURing(device);
+    }
+
+    static constexpr size_t kMaxBatchSize = 64;
+
+    CommandQueue& queue = device.queue;
+
+    std::vector<Command> batch;
+
+    std::vector<iovec> vectors;
+
+    while (true)
+    {
+        // Wait for the first command and then take what else is queued in the order of priority
+        // The batch is bounded, so a command in a higher lane waits for at most one batch
+        batch.clear();
+
+        batch.push_back(queue.poll());
+
+        queue.drainTo(batch, kMaxBatchSize - 1);
+
+        // Send the whole batch again if the device is reconnected in the middle
+        while (true)
+        {
+            uint32_t epoch = device.epoch.load(std::memory_order_acquire);
+
+            if (epoch % 2 != 0)
+            {
+                if (device.options.dropOffline)
+                {
+                    pinfo("Dropped %zu messages sent to the %s device while it is disconnected.", batch.size(), device.name.c_str());
+
+                    break;
+                }
+
+                epoch = waitForConnection(device);
+            }
+
+            // Send all messages with a single system call
+            vectors.clear();
+
+            for (Command& command : batch)
+            {
+                vectors.push_back({ &command.message, sizeof(Message) });
+            }
+
+            if (device.socket.sendWithVectors(vectors.data(), vectors.size()))
+            {
+                auto now = std::chrono::steady_clock::now();
+
+                for (const Command& command : batch)
+                {
+                    device.latencies[command.lane].record(now - command.produced);
+                }
+
+                break;
+            }
+
+            perr("Failed to send %zu messages to the %s device.", vectors.size(), device.name.c_str());
+
+            this->disconnect(device, epoch);
+        }
+    }
+}
+
+///
+/// The sender thread implementation that submits batched sends to io_uring
+///
+/// @param device The device to which the thread sends messages
+///
+void Controller::senderWithIOURing(Device& device)
+{
+#if IOURING_AVAILABLE
+    /// A command in the current batch
+    struct Entry
+    {
+        /// The command to send
+        Command command;
+
+        /// The number of bytes that have been sent
+        size_t offset;
+    };
+
+    static constexpr size_t kMaxBatchSize = 64;
+
+    CommandQueue& queue = device.queue;
+
+    int descriptor = device.socket.getDescriptor();
+
+    IOURing uring(kMaxBatchSize);
+
+    std::vector<Entry> batch;
+
+    batch.reserve(kMaxBatchSize);
+
+    while (true)
+    {
+        // Wait for the first command and then take what else is queued in the order of priority
+        batch.clear();
+
+        batch.push_back({ queue.poll(), 0 });
+
+        while (batch.size() < kMaxBatchSize)
+        {
+            auto command = queue.tryPoll();
+
+            if (!command)
+            {
+                break;
+            }
+
+            batch.push_back({ *command, 0 });
+        }
+
+        // Submit all commands at once and resubmit those that are sent partially until the batch is done
+        size_t outstanding = batch.size();
+
+        while (outstanding > 0)
+        {
+            uint32_t epoch = device.epoch.load(std::memory_order_acquire);
+
+            if (epoch % 2 != 0)
+            {
+                if (device.options.dropOffline)
+                {
+                    pinfo("Dropped %zu messages sent to the %s device while it is disconnected.", outstanding, device.name.c_str());
+
+                    break;
+                }
+
+                epoch = waitForConnection(device);
+            }
+
+            uint32_t submitted = 0;
+
+            io_uring_sqe* previous = nullptr;
+
+            for (size_t entryIndex = 0; entryIndex < batch.size(); entryIndex += 1)
+            {
+                Entry& entry = batch[entryIndex];
+
+                if (entry.offset == sizeof(Message))
+                {
+                    continue;
+                }
+
+                // Preserve the order of messages by linking each send to the previous one
+                if (previous != nullptr)
+                {
+                    previous->flags |= IOSQE_IO_LINK;
+                }
+
+                previous = uring.getSubmissionQueueEntry();
+
+                IOURing::prepareSend(previous,
+                                     descriptor,
+                                     reinterpret_cast<const uint8_t*>(&entry.command.message) + entry.offset,
+                                     sizeof(Message) - entry.offset,
+                                     entryIndex);
+
+                submitted += 1;
+            }
+
+            passert(uring.submit(submitted) >= 0, "Failed to submit sends to io_uring. Reason: %s.", errorstr);
+
+            uint32_t completed = 0;
+
+            bool failed = false;
+
+            while (completed < submitted)
+            {
+                completed += uring.complete([&](const io_uring_cqe& cqe)
+                {
+                    Entry& entry = batch[cqe.user_data];
+
+                    if (cqe.res == -ECANCELED)
+                    {
+                        // A previous send in the chain is incomplete
+                        return;
+                    }
+
+                    if (cqe.res <= 0)
+                    {
+                        // The message is sent again once the device is reconnected
+                        failed = true;
+                    }
+                    else
+                    {
+                        entry.offset += cqe.res;
+                    }
+
+                    if (entry.offset == sizeof(Message))
+                    {
+                        outstanding -= 1;
+
+                        device.latencies[entry.command.lane].record(std::chrono::steady_clock::now() - entry.command.produced);
+                    }
+                });
+
+                if (completed < submitted)
+                {
+                    passert(uring.submit(submitted - completed) >= 0, "Failed to wait for completions. Reason: %s.", errorstr);
+                }
+            }
+
+            if (failed)
+            {
+                perr("Failed to send %zu messages to the %s device.", outstanding, device.name.c_str());
+
+                this->disconnect(device, epoch);
+
+                // Messages sent partially over the lost connection are sent again from the beginning
+                for (Entry& entry : batch)
+                {
+                    entry.offset = entry.offset == sizeof(Message) ? entry.offset : 0;
+                }
+            }
+        }
+    }
+#else
+    pfatal("The io_uring transport is not supported on this platform.");
+#endif
+}
+
+///
+/// Validate the receive options of the given device and enable busy polling on its socket if requested
+///
+/// @param device A device
+/// @note The function must be called before any thread starts to use the socket.
+///
+void Controller::configureReceiveOptions(Device& device)
+{
+    const char* name = device.name.c_str();
+
+    // Guard: The user does not tune the receive path
+    if (!device.options.spin && !device.options.cpu)
+    {
+        return;
+    }
+
+    // Guard: A multiplexing thread serves multiple devices, so it cannot spin on or be pinned for one of them
+    if (device.role != Role::kGateway && (this->options.transport == Transport::kIOURing || this->options.reactor))
+    {
+        pwarning("Busy polling and thread pinning are ignored for the %s device because its messages are multiplexed.", name);
+
+        device.options.spin = false;
+
+        device.options.cpu = std::nullopt;
+
+        return;
+    }
+
+    // Guard: The user does not request busy polling
+    if (!device.options.spin)
+    {
+        return;
+    }
+
+    if (device.socket.setBusyPolling(true))
+    {
+        pinfo("The thread that receives messages from the %s device will spin.", name);
+    }
+    else
+    {
+        pwarning("Failed to enable busy polling for the %s device. Reason: %s.", name, strerror(errno));
+
+        device.options.spin = false;
+    }
+}
+
+///
+/// Pin the calling thread to the processor designated for the given device
+///
+/// @param device The device from which the calling thread receives messages
+///
+void Controller::pinReceiverThread(const Device& device)
+{
+    const char* name = device.name.c_str();
+
+    auto cpu = device.options.cpu;
+
+    // Guard: The user does not designate a processor
+    if (!cpu)
+    {
+        return;
+    }
+
+#if defined(__linux__)
+    cpu_set_t set;
+
+    CPU_ZERO(&set);
+
+    CPU_SET(*cpu, &set);
+
+    int result = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+
+    if (result == 0)
+    {
+        pinfo("The thread that receives messages from the %s device is pinned to CPU %u.", name, *cpu);
+    }
+    else
+    {
+        pwarning("Failed to pin the thread that receives messages from the %s device to CPU %u. Reason: %s.", name, *cpu, strerror(result));
+    }
+#else
+    pwarning("Thread pinning is not supported on this platform. The thread that receives messages from the %s device is not pinned.", name);
+#endif
+}
+
+///
+/// The receiver thread implementation
+///
+/// @param device The device from which to receive data
+///
+void Controller::receiver(Device& device)
+{
+    pinReceiverThread(device);
+
+    Connection connection;
+
+    uint32_t epoch = device.epoch.load(std::memory_order_acquire);
+
+    // Run loop
+    while (true)
+    {
+        // Receive as many messages as available from the designated socket
+        if (!connection.receive(device.socket))
+        {
+            perr("Failed to receive the message from the %s device.", device.name.c_str());
+
+            // Resume with an empty buffer once the device is reconnected
+            this->disconnect(device, epoch);
+
+            epoch = waitForConnection(device);
+
+            connection.reset();
+
+            continue;
+        }
+
+        while (auto message = connection.next())
+        {
+            this->dispatch(device, *message);
+        }
+    }
+}
+
+///
+/// The reactor thread implementation
+///
+/// @note The reactor thread multiplexes the sockets of all monitor and actuator devices,
+///       replacing the dedicated receiver thread of each device.
+///
+void Controller::reactor()
+{
+#if REACTOR_AVAILABLE
+    static constexpr uint64_t kDoorbell = UINT64_MAX;
+
+    Reactor reactor;
+
+    // Connections, epochs and states indexed by device identifiers
+    std::vector<Connection> connections(this->devices.getCount());
+
+    std::vector<uint32_t> epochs(this->devices.getCount());
+
+    std::vector<bool> watched(this->devices.getCount());
+
+    // Each token carries the epoch of the connection, so events from a replaced connection are ignored
+    auto watch = [&](Device& device)
+    {
+        uint32_t epoch = device.epoch.load(std::memory_order_acquire);
+
+        // Devices accepted by a listener may join after the reactor starts
+        if (device.identifier >= watched.size())
+        {
+            connections.resize(device.identifier + 1);
+
+            epochs.resize(device.identifier + 1);
+
+            watched.resize(device.identifier + 1);
+        }
+
+        // Guard: The device is still disconnected, or the connection is already watched
+        if (epoch % 2 != 0 || (watched[device.identifier] && epochs[device.identifier] == epoch))
+        {
+            return;
+        }
+
+        if (watched[device.identifier])
+        {
+            reactor.remove(device.socket.getDescriptor());
+        }
+
+        passert(reactor.add(device.socket.getDescriptor(), static_cast<uint64_t>(epoch) << 32 | device.identifier),
+                "Failed to monitor the socket of the %s device.", device.name.c_str());
+
+        connections[device.identifier].reset();
+
+        epochs[device.identifier] = epoch;
+
+        watched[device.identifier] = true;
+    };
+
+    this->devices.forEach(Role::kMonitor, watch);
+
+    this->devices.forEach(Role::kActuator, watch);
+
+    passert(reactor.add(this->doorbell.getDescriptor(), kDoorbell), "Failed to monitor the doorbell.");
+
+    // Receive data from the socket that becomes readable
+    auto handler = [&](uint64_t token, uint32_t)
+    {
+        // Watch the devices that have been reconnected or attached
+        if (token == kDoorbell)
+        {
+            this->doorbell.clear();
+
+            this->devices.forEach(Role::kMonitor, watch);
+
+            this->devices.forEach(Role::kActuator, watch);
+
+            return;
+        }
+
+        Device& device = *this->devices.get(static_cast<DeviceID>(token));
+
+        // Guard: The event belongs to a connection that is no longer watched
+        if (!watched[device.identifier] || epochs[device.identifier] != static_cast<uint32_t>(token >> 32))
+        {
+            return;
+        }
+
+        Connection& connection = connections[device.identifier];
+
+        // Receive whatever the device has sent so far
+        if (!connection.receive(device.socket))
+        {
+            perr("Failed to receive the message from the %s device.", device.name.c_str());
+
+            reactor.remove(device.socket.getDescriptor());
+
+            watched[device.identifier] = false;
+
+            this->disconnect(device, epochs[device.identifier]);
+
+            return;
+        }
+
+        while (auto message = connection.next())
+        {
+            this->dispatch(device, *message);
+        }
+    };
+
+    // Run loop
+    while (true)
+    {
+        passert(reactor.poll(handler) >= 0, "Failed to wait for events. Reason: %s.", errorstr);
+    }
+#else
+    pfatal("The reactor is not supported on this platform.");
+#endif
+}
+
+///
+/// The receiver thread implementation that multiplexes sockets with io_uring receives
+///
+/// @note The thread replaces the dedicated receiver thread of all monitor and actuator devices.
+///
+void Controller::receiverWithIOURing()
+{
+#if IOURING_AVAILABLE
+    static constexpr uint16_t kBufferGroup = 0;
+
+    static constexpr uint16_t kBufferCount = 64;
+
+    static constexpr uint32_t kBufferSize = 4096;
+
+    IOURing uring(kBufferCount);
+
+    IOURing::BufferGroup buffers(uring, kBufferGroup, kBufferCount, kBufferSize);
+
+    static constexpr uint64_t kDoorbell = IOURing::BufferGroup::kUserData - 1;
+
+    // Connections, receive modes, epochs and states indexed by device identifiers
+    std::vector<Connection> connections(this->devices.getCount());
+
+    std::vector<bool> multishot(this->devices.getCount());
+
+    std::vector<uint32_t> epochs(this->devices.getCount());
+
+    std::vector<bool> watched(this->devices.getCount());
+
+    auto getSubmissionQueueEntry = [&]() -> io_uring_sqe*
+    {
+        io_uring_sqe* sqe = uring.getSubmissionQueueEntry();
+
+        // Flush the prepared entries if the submission queue is full
+        if (sqe == nullptr)
+        {
+            passert(uring.submit() >= 0, "Failed to submit receives to io_uring. Reason: %s.", errorstr);
+
+            sqe = uring.getSubmissionQueueEntry();
+        }
+
+        return sqe;
+    };
+
+    // Each receive carries the epoch of the connection, so completions from a replaced connection are ignored
+    auto arm = [&](const Device& device)
+    {
+        IOURing::prepareReceive(getSubmissionQueueEntry(),
+                                device.socket.getDescriptor(),
+                                multishot[device.identifier],
+                                kBufferGroup,
+                                static_cast<uint64_t>(epochs[device.identifier]) << 32 | device.identifier);
+    };
+
+    auto watch = [&](const Device& device)
+    {
+        uint32_t epoch = device.epoch.load(std::memory_order_acquire);
+
+        // Devices accepted by a listener may join after the thread starts
+        if (device.identifier >= watched.size())
+        {
+            connections.resize(device.identifier + 1);
+
+            multishot.resize(device.identifier + 1);
+
+            epochs.resize(device.identifier + 1);
+
+            watched.resize(device.identifier + 1);
+        }
+
+        // Guard: The device is still disconnected, or the connection is already watched
+        if (epoch % 2 != 0 || (watched[device.identifier] && epochs[device.identifier] == epoch))
+        {
+            return;
+        }
+
+        // Terminal devices do not support multishot receives
+        multishot[device.identifier] = device.socket.isSocket();
+
+        connections[device.identifier].reset();
+
+        epochs[device.identifier] = epoch;
+
+        watched[device.identifier] = true;
+
+        arm(device);
+    };
+
+    this->devices.forEach(Role::kMonitor, watch);
+
+    this->devices.forEach(Role::kActuator, watch);
+
+    IOURing::prepareWaitReadable(getSubmissionQueueEntry(), this->doorbell.getDescriptor(), kDoorbell);
+
+    // Run loop
+    while (true)
+    {
+        passert(uring.submit(1) >= 0, "Failed to wait for completions. Reason: %s.", errorstr);
+
+        uring.complete([&](const io_uring_cqe& cqe)
+        {
+            // Guard: A buffer cannot be returned to the kernel
+            if (cqe.user_data == IOURing::BufferGroup::kUserData)
+            {
+                perr("Failed to recycle a receive buffer. Reason: %s.", strerror(-cqe.res));
+
+                return;
+            }
+
+            // Watch the devices that have been reconnected or attached
+            if (cqe.user_data == kDoorbell)
+            {
+                this->doorbell.clear();
+
+                this->devices.forEach(Role::kMonitor, watch);
+
+                this->devices.forEach(Role::kActuator, watch);
+
+                IOURing::prepareWaitReadable(getSubmissionQueueEntry(), this->doorbell.getDescriptor(), kDoorbell);
+
+                return;
+            }
+
+            Device& device = *this->devices.get(static_cast<DeviceID>(cqe.user_data));
+
+            Connection& connection = connections[device.identifier];
+
+            // The completion belongs to a connection that is no longer watched
+            bool stale = !watched[device.identifier] || epochs[device.identifier] != static_cast<uint32_t>(cqe.user_data >> 32);
+
+            if (cqe.flags & IORING_CQE_F_BUFFER)
+            {
+                auto identifier = static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+
+                const uint8_t* data = buffers.getBuffer(identifier);
+
+                for (size_t offset = 0; !stale && cqe.res > 0 && offset < static_cast<size_t>(cqe.res);)
+                {
+                    offset += connection.append(data + offset, cqe.res - offset);
+
+                    while (auto message = connection.next())
+                    {
+                        this->dispatch(device, *message);
+                    }
+                }
+
+                buffers.recycle(identifier);
+            }
+
+            // Guard: The receive remains armed or belongs to a replaced connection
+            if (cqe.flags & IORING_CQE_F_MORE || stale)
+            {
+                return;
+            }
+
+            // Guard: The receive is completed or terminated because the kernel has run out of buffers
+            if (cqe.res > 0 || cqe.res == -ENOBUFS)
+            {
+                arm(device);
+
+                return;
+            }
+
+            perr("Failed to receive the message from the %s device.", device.name.c_str());
+
+            watched[device.identifier] = false;
+
+            this->disconnect(device, epochs[device.identifier]);
+        });
+    }
+#else
+    pfatal("The io_uring transport is not supported on this platform.");
+#endif
+}
+
+///
+/// The acceptor thread implementation
+///
+/// @note The acceptor thread accepts connections on all listeners, identifies the role of each device
+///       and attaches the device without blocking the other devices.
+///
+void Controller::acceptor()
+{
+    using Clock = std::chrono::steady_clock;
+
+    /// A connection whose device has not identified itself yet
+    struct Pending
+    {
+        /// A non-blocking socket connected to the device
+        StreamSocket socket;
+
+        /// The index of the listener that has accepted the connection
+        size_t listener;
+
+        /// The first message received so far
+        std::array<uint8_t, sizeof(Message)> bytes;
+
+        /// The number of bytes received so far
+        size_t received;
+
+        /// The point in time after which the connection is rejected
+        Clock::time_point deadline;
+
+        /// `true` if the connection has been attached or rejected
+        bool done;
+    };
+
+    std::vector<Pending> pendings;
+
+    std::vector<pollfd> descriptors;
+
+    while (true)
+    {
+        descriptors.clear();
+
+        for (const Listener& listener : this->listeners)
+        {
+            descriptors.push_back({ .fd = listener.socket.getDescriptor(), .events = POLLIN, .revents = 0 });
+        }
+
+        auto deadline = Clock::time_point::max();
+
+        for (const Pending& pending : pendings)
+        {
+            descriptors.push_back({ .fd = pending.socket.getDescriptor(), .events = POLLIN, .revents = 0 });
+
+            deadline = std::min(deadline, pending.deadline);
+        }
+
+        auto remaining = std::chrono::ceil<std::chrono::milliseconds>(deadline - Clock::now());
+
+        int timeout = deadline == Clock::time_point::max() ? -1 : static_cast<int>(std::max<int64_t>(remaining.count(), 0));
+
+        passert(poll(descriptors.data(), descriptors.size(), timeout) >= 0 || errno == EINTR, "Failed to wait for connections. Reason: %s.", errorstr);
+
+        auto now = Clock::now();
+
+        // Receive the first message from each device that must identify itself
+        for (size_t index = 0; index < pendings.size(); index += 1)
+        {
+            Pending& pending = pendings[index];
+
+            if (descriptors[this->listeners.size() + index].revents != 0)
+            {
+                ssize_t result = read(pending.socket.getDescriptor(), pending.bytes.data() + pending.received, sizeof(Message) - pending.received);
+
+                if (result <= 0 && !(result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)))
+                {
+                    pinfo("Rejected a device on %s. Reason: The device closed the connection before identifying itself.",
+                          this->listeners[pending.listener].endpoint.description().c_str());
+
+                    pending.done = true;
+
+                    continue;
+                }
+
+                pending.received += static_cast<size_t>(std::max<ssize_t>(result, 0));
+            }
+
+            if (pending.received == sizeof(Message))
+            {
+                auto message = std::bit_cast<Message>(pending.bytes);
+
+                if (auto role = identify(message))
+                {
+                    this->attach(*role, pending.listener, std::move(pending.socket), message);
+                }
+                else
+                {
+                    pinfo("Rejected a device on %s. Reason: The first message does not report a user stack.",
+                          this->listeners[pending.listener].endpoint.description().c_str());
+                }
+
+                pending.done = true;
+            }
+            else if (now >= pending.deadline)
+            {
+                pinfo("Rejected a device on %s. Reason: Timed out after receiving %zu of %zu bytes.",
+                      this->listeners[pending.listener].endpoint.description().c_str(), pending.received, sizeof(Message));
+
+                pending.done = true;
+            }
+        }
+
+        std::erase_if(pendings, [](const Pending& pending) -> bool { return pending.done; });
+
+        // Accept new connections
+        for (size_t index = 0; index < this->listeners.size(); index += 1)
+        {
+            const Listener& listener = this->listeners[index];
+
+            if (descriptors[index].revents == 0)
+            {
+                continue;
+            }
+
+            try
+            {
+                while (auto socket = listener.socket.accept())
+                {
+                    if (listener.role)
+                    {
+                        this->attach(*listener.role, index, std::move(*socket), std::nullopt);
+                    }
+                    else
+                    {
+                        pendings.push_back({ std::move(*socket), index, {}, 0, now + listener.endpoint.timeout, false });
+                    }
+                }
+            }
+            catch (SocketException& exception)
+            {
+                perr("%s", exception.what());
+            }
+        }
+    }
+}
+
+///
+/// Attach a device that has connected to a listener
+///
+/// @param role The role of the device
+/// @param listener The index of the listener that has accepted the device
+/// @param socket A socket connected to the device
+/// @param message The message with which the device has identified itself, if any
+/// @note A device that reconnects to the same listener takes over the disconnected device that has the same role.
+///
+void Controller::attach(Role role, size_t listener, StreamSocket socket, std::optional<Message> message)
+{
+    const Endpoint& endpoint = this->listeners[listener].endpoint;
+
+    // Guard: Threads that serve the device expect a blocking socket
+    if (!socket.setBlocking(true))
+    {
+        perr("Failed to attach the %s device on %s. Reason: %s.", Role2String(role), endpoint.description().c_str(), strerror(errno));
+
+        return;
+    }
+
+    // Take over the first disconnected device that was accepted by the same listener
+    Device* previous = nullptr;
+
+    this->devices.forEach(role, [&](Device& device) -> void
+    {
+        if (previous == nullptr && device.listener == listener && !device.isConnected())
+        {
+            previous = &device;
+        }
+    });
+
+    if (previous != nullptr)
+    {
+        Device& device = *previous;
+
+        const char* name = device.name.c_str();
+
+        if (!device.socket.replace(std::move(socket)))
+        {
+            perr("Failed to reattach the %s device. Reason: %s.", name, strerror(errno));
+
+            return;
+        }
+
+        // The new connection does not inherit the status flags of the old one
+        if (device.options.spin && !device.socket.setBusyPolling(true))
+        {
+            pwarning("Failed to enable busy polling for the %s device. Reason: %s.", name, strerror(errno));
+        }
+
+        if (message)
+        {
+            this->dispatch(device, *message);
+        }
+
+        device.epoch.fetch_add(1, std::memory_order_release);
+
+        device.reconnected.signal();
+
+    #if DOORBELL_AVAILABLE
+        this->doorbell.ring();
+    #endif
+
+        status("Reconnected to the %s device.", name);
+
+        return;
+    }
+
+    Device* device = this->devices.add(role, endpoint, std::move(socket), DeviceOptions{ .spin = endpoint.spin, .cpu = endpoint.cpu, .dropOffline = endpoint.dropOffline, .queue = endpoint.queue },
+                                       this->options.lanes, listener, this->routingTable);
+
+    // Guard: The registry is full
+    if (device == nullptr)
+    {
+        perr("Failed to attach the %s device on %s. Reason: Too many devices.", Role2String(role), endpoint.description().c_str());
+
+        return;
+    }
+
+    this->configureReceiveOptions(*device);
+
+    if (message)
+    {
+        this->dispatch(*device, *message);
+    }
+
+    status("Attached the %s device on %s.", device->name.c_str(), endpoint.description().c_str());
+
+    this->start(*device);
+}
+
+///
+/// Identify the role of a device from the first message it sends
+///
+/// @param message The first message received from the device
+/// @return The role on success, `std::nullopt` if the message does not report a user stack.
+///
+std::optional<Controller::Role> Controller::identify(const Message& message)
+{
+    if (message.magic != Message(Message::kMoistureUserStack, 0).magic)
+    {
+        return std::nullopt;
+    }
+
+    switch (message.type)
+    {
+        case Message::kMoistureUserStack:
+            return Role::kMonitor;
+
+        case Message::kActuatorUserStack:
+            return Role::kActuator;
+
+        case Message::kGateWayUserStack:
+            return Role::kGateway;
+
+        default:
+            return std::nullopt;
+    }
+}
+
+///
+/// Start the threads that serve the given device
+///
+/// @param device A device that has been configured
+/// @note Devices whose messages are multiplexed are picked up by the running multiplexing thread.
+///
+void Controller::start(Device& device)
+{
+    std::lock_guard<std::mutex> guard(this->threadsLock);
+
+    this->threads.emplace_back(&Controller::sender, this, std::ref(device));
+
+    // Guard: Gateway devices are served by the command line interface
+    if (device.role == Role::kGateway)
+    {
+        return;
+    }
+
+    if (this->options.transport == Transport::kIOURing || this->options.reactor)
+    {
+    #if DOORBELL_AVAILABLE
+        this->doorbell.ring();
+    #endif
+
+        return;
+    }
+
+    this->threads.emplace_back(&Controller::receiver, this, std::ref(device));
+}
+
+///
+/// The supervisor thread implementation
+///
+/// @note The supervisor thread reconnects to each disconnected device that is not accepted by a listener with exponential backoff,
+///       receives the preamble again and then wakes up the threads that wait for the device.
+///       It also reports the queues that have crossed a watermark, so threads that enqueue commands never print.
+///
+void Controller::supervisor()
+{
+    using Clock = std::chrono::steady_clock;
+
+    /// The reconnection schedule of a disconnected device
+    struct Backoff
+    {
+        /// The epoch at which the device was disconnected
+        uint32_t epoch;
+
+        /// The amount of time to wait before the next attempt
+        std::chrono::milliseconds delay;
+
+        /// The point in time at which the next attempt starts
+        Clock::time_point deadline;
+    };
+
+    static constexpr std::chrono::milliseconds kInitialDelay(100);
+
+    static constexpr std::chrono::milliseconds kMaxDelay(10000);
+
+    // The interval at which queues are checked for watermark crossings
+    static constexpr std::chrono::milliseconds kWatermarkInterval(100);
+
+    // Schedules indexed by device identifiers
+    std::vector<Backoff> backoffs;
+
+    std::vector<std::array<std::pair<uint64_t, uint64_t>, kLaneCount>> watermarks;
+
+    std::vector<Device*> due;
+
+    std::vector<Endpoint> endpoints;
+
+    while (true)
+    {
+        uint32_t ticket = this->disconnections.load();
+
+        this->reportWatermarks(watermarks);
+
+        auto now = Clock::now();
+
+        auto deadline = now + kWatermarkInterval;
+
+        backoffs.resize(this->devices.getCount());
+
+        // Find the devices whose next attempt is due
+        due.clear();
+
+        this->devices.forEach([&](Device& device) -> void
+        {
+            uint32_t epoch = device.epoch.load(std::memory_order_acquire);
+
+            // Devices accepted by a listener connect to the controller again by themselves
+            if (epoch % 2 == 0 || device.listener)
+            {
+                return;
+            }
+
+            Backoff& backoff = backoffs[device.identifier];
+
+            // The device is disconnected for the first time since the last reconnection
+            if (backoff.epoch != epoch)
+            {
+                backoff = { epoch, kInitialDelay, now + kInitialDelay };
+            }
+
+            if (backoff.deadline <= now)
+            {
+                due.push_back(&device);
+            }
+            else
+            {
+                deadline = std::min(deadline, backoff.deadline);
+            }
+        });
+
+        // Guard: Wait until another device is disconnected or the next attempt is due
+        if (due.empty())
+        {
+            this->disconnections.wait(ticket, deadline - now);
+
+            continue;
+        }
+
+        // Reconnect to all due devices concurrently
+        endpoints.clear();
+
+        for (const Device* device : due)
+        {
+            endpoints.push_back(device->endpoint);
+        }
+
+        auto attempts = Connector::connect(endpoints);
+
+        for (size_t index = 0; index < due.size(); index += 1)
+        {
+            Device& device = *due[index];
+
+            Connector::Attempt& attempt = attempts[index];
+
+            Backoff& backoff = backoffs[device.identifier];
+
+            const char* name = device.name.c_str();
+
+            if (attempt.stage == Connector::kFailed || !device.socket.replace(std::move(*attempt.socket)))
+            {
+                backoff.delay = std::min(backoff.delay * 2, kMaxDelay);
+
+                backoff.deadline = Clock::now() + backoff.delay;
+
+                pinfo("Failed to reconnect to the %s device. Will retry in %lld ms.", name, static_cast<long long>(backoff.delay.count()));
+
+                continue;
+            }
+
+            if (attempt.stage == Connector::kIncomplete)
+            {
+                pwarning("Failed to receive the preamble from the %s device. Reason: %s.", name, attempt.error.c_str());
+            }
+
+            // The new connection does not inherit the status flags of the old one
+            if (device.options.spin && !device.socket.setBusyPolling(true))
+            {
+                pwarning("Failed to enable busy polling for the %s device. Reason: %s.", name, strerror(errno));
+            }
+
+            device.epoch.fetch_add(1, std::memory_order_release);
+
+            device.reconnected.signal();
+
+        #if DOORBELL_AVAILABLE
+            this->doorbell.ring();
+        #endif
+
+            status("Reconnected to the %s device.", name);
+        }
+    }
+}
+
+///
+/// Report the queues that have crossed a watermark since the last report
+///
+/// @param reported The number of times each lane of each device has reached the high and the low watermark at the last report,
+///                 indexed by device identifiers and updated on return
+///
+void Controller::reportWatermarks(std::vector<std::array<std::pair<uint64_t, uint64_t>, kLaneCount>>& reported)
+{
+    reported.resize(this->devices.getCount());
+
+    this->devices.forEach([&](Device& device) -> void
+    {
+        for (size_t lane = 0; lane < kLaneCount; lane += 1)
+        {
+            const auto& queue = device.queue.getLane(lane);
+
+            auto statistics = queue.getStatistics();
+
+            auto& [high, low] = reported[device.identifier][lane];
+
+            const char* name = Lane2String(static_cast<Lane>(lane));
+
+            if (statistics.highWatermarks != high)
+            {
+                status("The %s queue of the %s device has reached the high watermark %" PRIu64 " time(s) with %zu pending messages now.",
+                       name, device.name.c_str(), statistics.highWatermarks - high, queue.getCount());
+            }
+
+            if (statistics.lowWatermarks != low)
+            {
+                status("The %s queue of the %s device has drained to the low watermark %" PRIu64 " time(s) with %zu pending messages now.",
+                       name, device.name.c_str(), statistics.lowWatermarks - low, queue.getCount());
+            }
+
+            high = statistics.highWatermarks;
+
+            low = statistics.lowWatermarks;
+        }
+    });
+}
+
+///
+/// Report that the connection to the given device is lost
+///
+/// @param device The device whose connection is lost
+/// @param epoch The epoch of the device when the caller started to use the connection
+/// @note The report is ignored if the device has been disconnected or reconnected since the given epoch.
+///       Otherwise, the connection is shut down so that all threads blocked on it return,
+///       and the supervisor thread starts to reconnect to the device.
+///
+void Controller::disconnect(Device& device, uint32_t epoch)
+{
+    if (!device.epoch.compare_exchange_strong(epoch, epoch + 1, std::memory_order_acq_rel))
+    {
+        return;
+    }
+
+    device.socket.shutdown();
+
+    this->disconnections.signal();
+
+    status(device.listener ? "Lost the connection to the %s device. Will wait for it to connect again." : "Lost the connection to the %s device. Will reconnect.",
+           device.name.c_str());
+}
+
+///
+/// Wait until the given device is connected
+///
+/// @param device A device
+/// @return The epoch of the device once it is connected.
+///
+uint32_t Controller::waitForConnection(Device& device)
+{
+    while (true)
+    {
+        uint32_t ticket = device.reconnected.load();
+
+        uint32_t epoch = device.epoch.load(std::memory_order_acquire);
+
+        if (epoch % 2 == 0)
+        {
+            return epoch;
+        }
+
+        device.reconnected.wait(ticket);
+    }
+}
+
+///
+/// Process a message received from a device
+///
+/// @param device The device from which the message is received
+/// @param message A message received from the device
+/// @note The message is relayed according to the routes compiled from the routing table.
+///       A relayed command is dropped if the queue of its destination is full, since the receive thread may serve all devices.
+///
+void Controller::dispatch(const Device& device, const Message& message)
+{
+    if (message.magic != 0x4657)
+    {
+        perr("Received an invalid message from the %s device: Magic Mismatched.", device.name.c_str());
+
+        return;
+    }
+
+    // Guard: The message type is not expected from the device
+    if (message.type >= Router::kTypeCount || !device.routes[message.type].accepted)
+    {
+        perr("Received an unexpected message of type %u from the %s device.", message.type, device.name.c_str());
+
+        return;
+    }
+
+    status(kStatusFormats[message.type], device.name.c_str(), message.data);
+
+    // Relay the message to each destination device
+    // Acknowledgements close the control loop of the monitor device, so they do not wait behind relayed alerts
+    Lane lane = message.type == Message::kAckSoilWet ? Lane::kControl : Lane::kRelay;
+
+    Router::forEachDestination(device.routes[message.type], this->devices, device.identifier, [&](Device& destination) -> void
+    {
+        destination.queue.tryOffer(lane, Command(message, destination.role, lane));
+    });
+}
+
+///
+/// Submit a command to the queues of all devices of its destination role
+///
+/// @param command A command to send
+/// @param wait Pass `false` to drop the command for each device whose queue is full instead of waiting for room
+/// @note Commands sent to a role without any device are dropped.
+///
+void Controller::enqueue(const Command& command, bool wait)
+{
+    if (this->devices.getCount(command.role) == 0)
+    {
+        pwarning("Ignore messages sent to %s devices because none is connected.", Role2String(command.role));
+
+        return;
+    }
+
+    this->devices.forEach(command.role, [&](Device& device) -> void
+    {
+        wait ? device.queue.offer(command.lane, command) : device.queue.tryOffer(command.lane, command);
+    });
+}
+
+///
+/// Submit a command to the queue of the given device
+///
+/// @param command A command to send
+/// @param identifier The identifier of the destination device
+/// @param wait Pass `false` to drop the command if the queue of the device is full instead of waiting for room
+/// @note Commands sent to a device that does not exist or does not have the destination role are dropped.
+///
+void Controller::enqueue(const Command& command, DeviceID identifier, bool wait)
+{
+    Device* device = this->devices.get(identifier);
+
+    if (device == nullptr || device->role != command.role)
+    {
+        pwarning("Ignore messages sent to device #%u because it does not have the %s role.", identifier, Role2String(command.role));
+
+        return;
+    }
+
+    wait ? device->queue.offer(command.lane, command) : device->queue.tryOffer(command.lane, command);
+}
+
+///
+/// Submit a command to the device that the user refers to in a command
+///
+/// @param command A command to send
+/// @param args The arguments of the user command
+/// @param position The position of the optional device identifier in the arguments
+/// @note The command is sent to all devices of its destination role if the user does not specify an identifier.
+///
+void Controller::enqueue(const Command& command, const std::vector<std::string>& args, size_t position)
+{
+    if (args.size() <= position)
+    {
+        this->enqueue(command);
+    }
+    else if (Device* device = this->findDevice(args, position, command.role))
+    {
+        this->enqueue(command, device->identifier);
+    }
+}
+
+///
+/// Find the device that the user refers to in a command
+///
+/// @param args The arguments of the user command
+/// @param position The position of the optional device identifier in the arguments
+/// @param role The role that the device must have
+/// @return The device on success, `nullptr` if the identifier is invalid or no device of the role exists.
+/// @note The first device of the role is returned if the user does not specify an identifier.
+///
+Controller::Device* Controller::findDevice(const std::vector<std::string>& args, size_t position, Role role) const
+{
+    Device* result = nullptr;
+
+    // Use the first device of the role by default
+    if (args.size() <= position)
+    {
+        this->devices.forEach(role, [&](Device& device) -> void { result = result == nullptr ? &device : result; });
+
+        if (result == nullptr)
+        {
+            printf("No %s device is connected.\n", Role2String(role));
+        }
+
+        return result;
+    }
+
+    char* end = nullptr;
+
+    unsigned long identifier = strtoul(args[position].c_str(), &end, 10);
+
+    if (*end == '\0' && identifier <= UINT32_MAX)
+    {
+        result = this->devices.get(static_cast<DeviceID>(identifier));
+    }
+
+    if (result == nullptr || result->role != role)
+    {
+        printf("No %s device has the identifier [%s].\n", Role2String(role), args[position].c_str());
+
+        return nullptr;
+    }
+
+    return result;
+}
+
+///
+/// Print the controller status
+///
+/// @param format The format string
+///
+void Controller::status(const char* format, ...)
+{
+    char buffer[64] = {};
+
+    va_list args;
+
+    va_start(args, format);
+
+    flockfile(stdout);
+
+    time_t rawtime;
+
+    time(&rawtime);
+
+    struct tm* timeinfo = localtime(&rawtime);
+
+    strftime(buffer, sizeof(buffer), "%d-%m-%Y %H:%M:%S", timeinfo);
+
+    printf("\n");
+
+    printf("%s: \n", buffer);
+
+    vprintf(format, args);
+
+    printf("\n");
+
+    funlockfile(stdout);
+
+    va_end(args);
+}
+
+//
+// MARK: - Scheduled Commands
+//
+
+///
+/// The scheduler thread implementation
+///
+/// @note The scheduler thread sleeps until the next timer expires, collects the commands of all expired timers
+///       and then submits them to the queues of their destination devices without holding the timer lock.
+///       A command is dropped for a device whose queue is full, so a device that is offline cannot stall the others.
+///
+void Controller::scheduler()
+{
+    std::vector<ScheduledCommand> fired;
+
+    while (true)
+    {
+        // Load the ticket before advancing the wheel, so a timer scheduled in the meantime wakes up the thread
+        uint32_t ticket = this->timersChanged.load();
+
+        auto tick = static_cast<uint64_t>(std::chrono::floor<TimerTick>(TimerClock::now() - this->timersStart).count());
+
+        std::optional<uint64_t> next;
+
+        {
+            std::lock_guard<std::mutex> guard(this->timersLock);
+
+            this->timersSkipped += this->timers.advance(tick, [&](TimerID, const ScheduledCommand& scheduled) -> void { fired.push_back(scheduled); });
+
+            next = this->timers.getNextTick();
+        }
+
+        // A full queue must not hold up the commands of other devices, so commands are dropped instead of waiting for room
+        for (ScheduledCommand& scheduled : fired)
+        {
+            scheduled.command.produced = TimerClock::now();
+
+            if (scheduled.destination)
+            {
+                this->enqueue(scheduled.command, *scheduled.destination, false);
+            }
+            else
+            {
+                this->enqueue(scheduled.command, false);
+            }
+        }
+
+        fired.clear();
+
+        if (!next)
+        {
+            this->timersChanged.wait(ticket);
+
+            continue;
+        }
+
+        auto remaining = this->timersStart + TimerTick(*next) - TimerClock::now();
+
+        if (remaining.count() > 0)
+        {
+            this->timersChanged.wait(ticket, std::chrono::duration_cast<std::chrono::nanoseconds>(remaining));
+        }
+    }
+}
+
+///
+/// Schedule the command that the user specifies in a command
+///
+/// @param deadline The point in time at which the command is sent for the first time
+/// @param period The amount of time between two firings, or zero to send the command once
+/// @param args The arguments of the user command
+/// @param position The position of the scheduled command in the arguments
+/// @return The identifier of the timer on success, `std::nullopt` if the scheduled command is malformed.
+///
+std::optional<TimerID> Controller::schedule(TimerClock::time_point deadline, TimerTick period, const std::vector<std::string>& args, size_t position)
+{
+    const std::string& name = args[position];
+
+    std::optional<Command> command;
+
+    // The position of the optional device identifier in the arguments
+    size_t target = position + 1;
+
+    if (name == "soil" || name == "water")
+    {
+        char* end = nullptr;
+
+        long value = args.size() > position + 1 ? strtol(args[position + 1].c_str(), &end, 10) : 0;
+
+        if (end == nullptr || *end != '\0' || args.size() > position + 3)
+        {
+            printf("Usage: %s %s [device]\n", name.c_str(), name == "soil" ? "level" : "status");
+
+            return std::nullopt;
+        }
+
+        command = name == "soil" ? Command::changeSoilMoisture(static_cast<UInt32>(value)) : Command::changeWaterStatus(value != 0);
+
+        target = position + 2;
+    }
+    else if (name == "dry" || name == "wet")
+    {
+        if (args.size() > position + 2)
+        {
+            printf("Usage: %s [device]\n", name.c_str());
+
+            return std::nullopt;
+        }
+
+        command = name == "dry" ? Command::sendDrySoilAlertToActuatorDevice() : Command::sendWetSoilAlertToActuatorDevice();
+    }
+    else
+    {
+        printf("Cannot schedule the command [%s]. Supported commands are `soil`, `water`, `dry` and `wet`.\n", name.c_str());
+
+        return std::nullopt;
+    }
+
+    command->lane = Lane::kBulk;
+
+    ScheduledCommand scheduled = { *command, std::nullopt, name };
+
+    // Resolve the destination device once, so that each firing does not look it up again
+    if (args.size() > target)
+    {
+        const Device* device = this->findDevice(args, target, command->role);
+
+        if (device == nullptr)
+        {
+            return std::nullopt;
+        }
+
+        scheduled.destination = device->identifier;
+    }
+
+    for (size_t index = position + 1; index < args.size(); index += 1)
+    {
+        scheduled.description += " " + args[index];
+    }
+
+    auto expiry = static_cast<uint64_t>(std::max<int64_t>(std::chrono::ceil<TimerTick>(deadline - this->timersStart).count(), 0));
+
+    TimerID identifier;
+
+    {
+        std::lock_guard<std::mutex> guard(this->timersLock);
+
+        identifier = this->timers.schedule(expiry, static_cast<uint64_t>(period.count()), std::move(scheduled));
+    }
+
+    this->timersChanged.signal();
+
+    return identifier;
+}
+
+///
+/// Print all scheduled commands
+///
+void Controller::printTimers()
+{
+    struct Entry
+    {
+        TimerID identifier;
+
+        uint64_t expiry;
+
+        uint64_t period;
+
+        std::string description;
+    };
+
+    std::vector<Entry> entries;
+
+    uint64_t skipped;
+
+    {
+        std::lock_guard<std::mutex> guard(this->timersLock);
+
+        this->timers.forEach([&](TimerID identifier, uint64_t expiry, uint64_t period, const ScheduledCommand& scheduled) -> void
+        {
+            std::string description = scheduled.description;
+
+            if (scheduled.destination)
+            {
+                description += fmt::format(" (device #{})", *scheduled.destination);
+            }
+
+            entries.push_back({ identifier, expiry, period, std::move(description) });
+        });
+
+        skipped = this->timersSkipped;
+    }
+
+    std::sort(entries.begin(), entries.end(), [](const Entry& lhs, const Entry& rhs) -> bool { return lhs.expiry < rhs.expiry; });
+
+    auto now = std::chrono::floor<TimerTick>(TimerClock::now() - this->timersStart).count();
+
+    for (const Entry& entry : entries)
+    {
+        printf("Timer %" PRIu64 ": `%s` fires in %" PRId64 " ms", entry.identifier, entry.description.c_str(), std::max<int64_t>(static_cast<int64_t>(entry.expiry) - now, 0));
+
+        if (entry.period != 0)
+        {
+            printf(" and then every %" PRIu64 " ms", entry.period);
+        }
+
+        printf(".\n");
+    }
+
+    printf("%zu timers are scheduled; %" PRIu64 " periodic firings have been skipped.\n", entries.size(), skipped);
+}
+
+///
+/// Create a CoAP request message
+///
+/// @param buffer A buffer that contains the CoAP message on return
+/// @param moisture The moisture level
+/// @param identifier The message identifier
+///
+void Controller::makeCoAPRequestMessage(uint8_t (&buffer)[32], uint32_t moisture, uint16_t identifier)
+{
+    kMoistureRequest.instantiate(buffer, identifier, nullptr, &moisture);
+}
+
+///
+/// Send a CoAP request message to the gateway device and receive the translated HTTP request message
+///
+/// @param gateway The gateway device
+/// @param request The CoAP request message
+/// @param reader The reader that receives messages from the gateway device
+/// @return A view of the translated HTTP request message that remains valid until the reader receives more data.
+///
+HTTPRequestView Controller::sendRecvCoAPMessage(const Device& gateway, uint8_t (&request)[32], GatewayReader& reader)
+{
+    passert(gateway.socket.send(request, sizeof(request)), "Failed to send the CoAP request message.");
+
+    std::optional<HTTPRequestView> message;
+
+    while (!(message = reader.next()))
+    {
+        passert(!reader.getError(), "Received a malformed HTTP message. Reason: %s.", HTTPParseError2String(*reader.getError()));
+
+        passert(reader.receive(gateway.socket), "Failed to receive the HTTP message.");
+    }
+
+    return *message;
+}
+
+///
+/// Send a CoAP request message to the gateway device and receive the translated HTTP request message conveniently
+///
+/// @param gateway The gateway device
+///
+void Controller::sendRecvCoAPMessageOnce(const Device& gateway)
+{
+    uint8_t request[32] = {};
+
+    auto reader = makeGatewayReader();
+
+    makeCoAPRequestMessage(request, 100);
+
+    HTTPRequestView message = sendRecvCoAPMessage(gateway, request, reader);
+
+    status("Received a HTTP request message:");
+
+    printf("- Method = %.*s\n", static_cast<int>(message.method.size()), message.method.data());
+
+    printf("- Path = %.*s\n", static_cast<int>(message.path.size()), message.path.data());
+
+    printf("- Version = %.*s\n", static_cast<int>(message.version.size()), message.version.data());
+
+    printf("- Host = %.*s\n", static_cast<int>(message.host.size()), message.host.data());
+
+    printf("- Body = %zu bytes:", message.body.size());
+
+    for (char byte : message.body)
+    {
+        printf(" %02X", static_cast<uint8_t>(byte));
+    }
+
+    printf("\n");
+}
+
+///
+/// Send multiple CoAP request messages and receive translated HTTP request messages to measure the round trip time in nanoseconds
+///
+/// @param gateway The gateway device
+/// @param trials Specify the number of trails
+/// @param delayMS Specify the amount of time in milliseconds to wait until the next trial
+/// @return The experiment result.
+///
+ExecutionTimeMeasurer::Result Controller::sendRecvCoAPMessages(const Device& gateway, size_t trials, uint64_t delayMS, ValidationResult* validation)
+{
+    uint8_t request[32];
+
+    uint32_t moisture = 100;
+
+    auto reader = makeGatewayReader();
+
+    Controller::makeCoAPRequestMessage(request, moisture);
+
+    auto sendRecv = [&]() -> void
+    {
+        sendRecvCoAPMessage(gateway, request, reader);
+    };
+
+    if (validation == nullptr)
+    {
+        return ExecutionTimeMeasurer{}(trials, std::chrono::milliseconds(delayMS), sendRecv);
+    }
+
+    // The message that the gateway kernel produces for the request
+    char buffer[64];
+
+    std::string_view expected(buffer, HTTPMessageCreate(buffer, sizeof(buffer), kPost, kMoistureHost, kMoisturePort, kMoisturePath, &moisture, sizeof(moisture)));
+
+    // A slot holds one byte more than the expected message, which is enough to tell that a longer reply differs
+    size_t stride = expected.size() + 1;
+
+    std::vector<char> replies(trials * stride);
+
+    // The number of bytes stored in each slot
+    std::vector<size_t> lengths(trials);
+
+    // The reason for which each reply is malformed, or `std::nullopt` if it is a well-formed message
+    std::vector<std::optional<HTTPParseError>> errors(trials);
+
+    size_t trial = 0;
+
+    auto sendRecvAndStore = [&]() -> void
+    {
+        passert(gateway.socket.send(request, sizeof(request)), "Failed to send the CoAP request message.");
+
+        std::optional<HTTPRequestView> message;
+
+        while (!(message = reader.next()))
+        {
+            if (auto error = reader.getError())
+            {
+                errors[trial] = error;
+
+                reader.reset();
+
+                break;
+            }
+
+            // The reader also fails if its buffer is full of a message that does not end, which is reported as a parse error
+            passert(reader.receive(gateway.socket) || reader.getError(), "Failed to receive the HTTP message.");
+        }
+
+        if (message)
+        {
+            lengths[trial] = std::min(message->message.size(), stride);
+
+            memcpy(replies.data() + trial * stride, message->message.data(), lengths[trial]);
+        }
+
+        trial += 1;
+    };
+
+    auto result = ExecutionTimeMeasurer{}(trials, std::chrono::milliseconds(delayMS), sendRecvAndStore);
+
+    // Compare the replies once the measurement is over
+    for (trial = 0; trial < trials; trial += 1)
+    {
+        std::string_view reply(replies.data() + trial * stride, lengths[trial]);
+
+        auto offset = errors[trial] ? std::optional<size_t>(0) : findFirstMismatch(reply, expected);
+
+        if (!offset)
+        {
+            continue;
+        }
+
+        if (validation->mismatches == 0)
+        {
+            validation->firstTrial = trial;
+
+            validation->firstError = errors[trial];
+
+            validation->firstOffset = *offset;
+
+            validation->expected = *offset < expected.size() ? static_cast<uint8_t>(expected[*offset]) : -1;
+
+            validation->received = *offset < reply.size() ? static_cast<uint8_t>(reply[*offset]) : -1;
+        }
+
+        validation->mismatches += 1;
+
+        validation->malformed += errors[trial] ? 1 : 0;
+    }
+
+    return result;
+}
+
+///
+/// Run the gateway experiment
+///
+/// @param gateway The gateway device
+/// @param trials Specify the number of trails
+/// @param delayMS Specify the amount of time in milliseconds to wait until the next trial
+/// @param validate Pass `true` to check that each reply is the expected HTTP request message
+/// @note The calling thread is pinned to the processor designated for the gateway device.
+///
+void Controller::runGatewayExperiment(const Device& gateway, size_t trials, uint64_t delayMS, bool validate)
+{
+    pinReceiverThread(gateway);
+
+    printf("Running the gateway experiment on the %s device...\n", gateway.name.c_str());
+
+    printf("\tTrials = %zu; Delay = %" PRIu64 " milliseconds.\n", trials, delayMS);
+
+    ValidationResult validation;
+
+    auto result = sendRecvCoAPMessages(gateway, trials, delayMS, validate ? &validation : nullptr);
+
+    printf("Execution time:\n");
+
+    printf("- Min = %" PRIu64 " nanoseconds.\n", result.min());
+
+    printf("- Max = %" PRIu64 " nanoseconds.\n", result.max());
+
+    printf("- Med = %" PRIu64 " nanoseconds.\n", result.medium());
+
+    printf("- Avg = %.2f nanoseconds.\n", result.mean());
+
+    printf("- Std = %.2f nanoseconds.\n", result.sd());
+
+    if (!validate)
     {
-        return "";
+        return;
     }
 
-    auto end = string.find_last_not_of(whitespaces);
+    if (validation.mismatches == 0)
+    {
+        printf("Validation: All %zu replies match the expected HTTP request message.\n", trials);
 
-    return string.substr(start, end - start + 1);
-}
+        return;
+    }
 
-//
-// MARK: - Background Threads
-//
+    printf("Validation: %zu of %zu replies differ from the expected HTTP request message, and %zu of them are malformed.\n", validation.mismatches, trials, validation.malformed);
 
-/// The sender thread implementation
-void Controller::sender()
-{
-    while (true)
+    if (validation.firstError)
     {
-        auto command = this->queue.poll();
+        printf("- First mismatch in trial %zu: the reply is not an HTTP message. Reason: %s.\n", validation.firstTrial, HTTPParseError2String(*validation.firstError));
 
-        if (this->sockets[command.index])
-        {
-            psoftassert(this->sockets[command.index]->send(command.message),
-                        "Failed to send the message to the %s device.",
-                        SocketIndex2String(command.index));
-        }
-        else
+        return;
+    }
+
+    // Describe a byte of the message, or the end of the message
+    auto describe = [](int byte, char (&buffer)[16]) -> const char*
+    {
+        if (byte < 0)
         {
-            pwarning("Ignore messages sent to the %s device that is not connected.",
-                     SocketIndex2String(command.index));
+            return "the end of the message";
         }
-    }
+
+        snprintf(buffer, sizeof(buffer), "0x%02X", byte);
+
+        return buffer;
+    };
+
+    char expected[16], received[16];
+
+    printf("- First mismatch in trial %zu at offset %zu: expected %s but received %s.\n",
+           validation.firstTrial, validation.firstOffset, describe(validation.expected, expected), describe(validation.received, received));
 }
 
 ///
-/// The receiver thread implementation
+/// Send multiple CoAP request messages without waiting for the translated HTTP request messages in between
 ///
-/// @param index The index of the socket from which to receive data
+/// @param gateway The gateway device
+/// @param trials Specify the number of requests
+/// @param window Specify the maximum number of requests whose reply has not been received
+/// @return The experiment result.
+/// @note Each request carries its sequence number as the message identifier and the payload.
+///       The gateway copies the payload to the HTTP message, so replies are matched to requests by the payload,
+///       or to the oldest outstanding request if the payload does not identify an outstanding one.
 ///
-void Controller::receiver(SocketIndex index)
+Controller::PipelineResult Controller::sendRecvCoAPMessagesPipelined(const Device& gateway, size_t trials, size_t window)
 {
-    passert(this->sockets[index], "The socket should be connected.");
+    using Clock = std::chrono::steady_clock;
 
-    uint8_t buffer[32] = {};
+    PipelineResult result = { ExecutionTimeMeasurer::Result(trials), {}, 0, 0 };
 
-    this->receiveGarbageDataFromFastModels(index);
+    // The point in time at which each request is sent, or `std::nullopt` if its reply has been received
+    std::vector<std::optional<Clock::time_point>> outstanding(trials);
 
-    // Run loop
-    while (true)
+    std::vector<uint8_t> requests(window * 32);
+
+    auto reader = makeGatewayReader();
+
+    // The number of requests sent, the number of replies received and the oldest request without a reply
+    size_t sent = 0, received = 0, oldest = 0;
+
+    // Match the given reply to its request
+    auto match = [&](const HTTPRequestView& reply) -> void
     {
-        // Clear the buffer
-        bzero(buffer, sizeof(buffer));
+        auto now = Clock::now();
 
-        // Receive a message from the designated socket
-        if (!this->sockets[index]->receiveWithLength(buffer, sizeof(Message)))
+        while (oldest < sent && !outstanding[oldest])
         {
-            perr("Failed to receive the message from the %s device.", SocketIndex2String(index));
-
-            break;
+            oldest += 1;
         }
 
-        auto message = reinterpret_cast<Message*>(buffer);
+        size_t request = getHTTPRequestTag(reply);
 
-        if (message->magic != 0x4657)
+        if (request >= sent || !outstanding[request])
         {
-            perr("Received an invalid message from the %s device: Magic Mismatched.", SocketIndex2String(index));
+            passert(oldest < sent, "Received more HTTP messages than CoAP requests.");
 
-            continue;
-        }
+            request = oldest;
 
-        switch (message->type)
+            result.untagged += 1;
+        }
+        else if (request != oldest)
         {
-            case Message::Type::kMoistureUserStack:
-            {
-                // Received the user stack pointer address
-                status("Moisture device reports that the shared user stack starts at 0x%08x.", message->data);
+            result.reordered += 1;
+        }
 
-                break;
-            }
+        result.latencies.durations.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(now - *outstanding[request]).count());
 
-            case Message::Type::kActuatorUserStack:
-            {
-                // Received the user stack pointer address
-                status("Actuator device reports that the shared user stack starts at 0x%08x.", message->data);
+        outstanding[request].reset();
 
-                break;
-            }
+        received += 1;
+    };
 
-            case Message::Type::kGateWayUserStack:
-            {
-                // Received the user stack pointer address
-                status("Gateway device reports that a thread stack starts at 0x%08x.", message->data);
+    auto start = Clock::now();
 
-                break;
-            }
+    while (received < trials)
+    {
+        // Fill the window with a single write
+        size_t count = std::min(window - (sent - received), trials - sent);
 
-            case Message::Type::kSoilDryAlert:
-            {
-                // Relay to the actuator device
-                status("The controller has received a Soil Dry Alert message from the sensor device.\n");
+        for (size_t index = 0; index < count; index += 1)
+        {
+            auto request = reinterpret_cast<uint8_t(*)[32]>(&requests[index * 32]);
 
-                this->queue.offer(Command::relayMessageToActuatorDevice(*message));
+            makeCoAPRequestMessage(*request, static_cast<uint32_t>(sent + index), static_cast<uint16_t>(sent + index));
+        }
 
-                break;
-            }
+        if (count > 0)
+        {
+            auto now = Clock::now();
 
-            case Message::Type::kSoilWetAlert:
+            for (size_t index = 0; index < count; index += 1)
             {
-                // Relay to the actuator device
-                status("The controller has received a Soil Wet Alert message from the sensor device.\n");
-
-                this->queue.offer(Command::relayMessageToActuatorDevice(*message));
-
-                break;
+                outstanding[sent + index] = now;
             }
 
-            case Message::Type::kAckSoilWet:
-            {
-                // Relay to the sensor device
-                status("The controller has received a Ack Soil Wet message from the actuator device.\n");
-
-                this->queue.offer(Command::relayMessageToSensorDevice(*message));
-
-                break;
-            }
+            passert(gateway.socket.send(requests.data(), count * 32), "Failed to send the CoAP request messages.");
 
-            case Message::Type::kRunOutOfWaterAlert:
-            {
-                status("The controller has received a Run Out Of Water Alert message from the actuator device.\n");
+            sent += count;
+        }
 
-                break;
-            }
+        // Wait for some replies and then match each complete one
+        receiveHTTPRequests(gateway.socket, reader, match);
+    }
 
-            default:
-            {
-                perr("Message type is [%s]. Should never reach at here.", Message::Type2String(static_cast<Message::Type>(message->type)));
+    result.elapsed = Clock::now() - start;
 
-                break;
-            }
-        }
-    }
+    return result;
 }
 
 ///
-/// Print the controller status
+/// Run the pipelined gateway experiment
 ///
-/// @param format The format string
+/// @param gateway The gateway device
+/// @param trials Specify the number of requests
+/// @param window Specify the maximum number of requests whose reply has not been received
+/// @note The calling thread is pinned to the processor designated for the gateway device.
 ///
-void Controller::status(const char* format, ...)
+void Controller::runPipelinedGatewayExperiment(const Device& gateway, size_t trials, size_t window)
 {
-    char buffer[64] = {};
-
-    va_list args;
+    pinReceiverThread(gateway);
 
-    va_start(args, format);
+    printf("Running the pipelined gateway experiment on the %s device...\n", gateway.name.c_str());
 
-    flockfile(stdout);
+    printf("\tRequests = %zu; Window = %zu.\n", trials, window);
 
-    time_t rawtime;
+    auto result = sendRecvCoAPMessagesPipelined(gateway, trials, window);
 
-    time(&rawtime);
+    double seconds = std::chrono::duration<double>(result.elapsed).count();
 
-    struct tm* timeinfo = localtime(&rawtime);
+    printf("Throughput = %.2f requests per second over %.3f seconds.\n", static_cast<double>(trials) / seconds, seconds);
 
-    strftime(buffer, sizeof(buffer), "%d-%m-%Y %H:%M:%S", timeinfo);
+    printf("Replies = %zu reordered, %zu matched in order without a tag.\n", result.reordered, result.untagged);
 
-    printf("\n");
+    printf("Latency:\n");
 
-    printf("%s: \n", buffer);
+    printf("- Min = %" PRIu64 " nanoseconds.\n", result.latencies.min());
 
-    vprintf(format, args);
+    printf("- Max = %" PRIu64 " nanoseconds.\n", result.latencies.max());
 
-    printf("\n");
+    printf("- Med = %" PRIu64 " nanoseconds.\n", result.latencies.medium());
 
-    funlockfile(stdout);
+    printf("- Avg = %.2f nanoseconds.\n", result.latencies.mean());
 
-    va_end(args);
+    printf("- Std = %.2f nanoseconds.\n", result.latencies.sd());
 }
 
 ///
-/// Create a CoAP request message
+/// Send CoAP request messages on a precomputed schedule regardless of when the translated HTTP request messages arrive
 ///
-/// @param buffer A buffer that contains the CoAP message on return
-/// @param moisture The moisture level
+/// @param gateway The gateway device
+/// @param trials Specify the number of requests
+/// @param rate Specify the target number of requests per second
+/// @param arrival Specify the process that spaces requests
+/// @return The experiment result.
+/// @note A dedicated thread sends requests at their intended times while the calling thread receives replies,
+///       so a slow gateway does not lower the offered load. Replies are matched to requests in the same way as the pipelined experiment.
 ///
-void Controller::makeCoAPRequestMessage(uint8_t (&buffer)[32], uint32_t moisture)
+Controller::LoadResult Controller::sendRecvCoAPMessagesOpenLoop(const Device& gateway, size_t trials, double rate, Arrival arrival)
 {
-    uint8_t* ptr = buffer;
+    using Clock = std::chrono::steady_clock;
 
-    // Construct the header (4 bytes)
-    auto header = reinterpret_cast<CoAPHeader*>(ptr);
+    // The maximum number of overdue requests sent with a single write
+    static constexpr size_t kMaxBatchSize = 1024;
 
-    header->version = 0x01;
+    // The intended send time of each request relative to the start of the experiment
+    std::vector<std::chrono::nanoseconds> schedule(trials);
 
-    header->type = 0x01;
+    std::mt19937_64 generator(std::random_device{}());
 
-    header->tokenLength = 0x00;
+    std::exponential_distribution<double> gaps(rate);
 
-    header->code = kPost;
+    double offset = 0;
 
-    header->msgID = 0x4657;
+    for (auto& time : schedule)
+    {
+        time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<double>(offset));
 
-    ptr += sizeof(CoAPHeader);
+        offset += arrival == kPoisson ? gaps(generator) : 1.0 / rate;
+    }
 
-    // Construct the option - host address (10 bytes)
-    auto address = "localhost";
+    // The points in time at which each request is sent and its reply is received
+    // Each vector is written by a single thread and read once the sender thread has finished.
+    std::vector<Clock::time_point> sentTimes(trials), repliedTimes(trials);
 
-    auto length = strlen(address);
+    // The number of requests that the sender thread is about to send or has sent
+    // The count is published before the requests are written, so a reply never refers to a request that is not counted yet.
+    std::atomic<size_t> published = 0;
 
-    *ptr = kURIHost << 4 | length;
+    auto start = Clock::now();
 
-    memcpy(ptr + 1, address, length);
+    std::thread sender([&]() -> void
+    {
+        std::vector<uint8_t> requests(kMaxBatchSize * 32);
 
-    ptr += 1 + length;
+        for (size_t sent = 0; sent < trials;)
+        {
+            std::this_thread::sleep_until(start + schedule[sent]);
 
-    // Construct the option - host port (3 bytes)
-    *ptr = (kURIPort - kURIHost) << 4 | 2;
+            // Send all requests that are due with a single write, so a late sender catches up instead of drifting
+            auto now = Clock::now();
 
-    *reinterpret_cast<uint16_t*>(ptr + 1) = htons(10086);
+            size_t count = 1;
 
-    ptr += 1 + sizeof(uint16_t);
+            while (count < kMaxBatchSize && sent + count < trials && start + schedule[sent + count] <= now)
+            {
+                count += 1;
+            }
 
-    // Construct the option - query path (10 bytes)
-    auto path = "/moisture";
+            for (size_t index = 0; index < count; index += 1)
+            {
+                auto request = reinterpret_cast<uint8_t(*)[32]>(&requests[index * 32]);
 
-    length = strlen(path);
+                makeCoAPRequestMessage(*request, static_cast<uint32_t>(sent + index), static_cast<uint16_t>(sent + index));
+            }
 
-    *ptr = (kURIPath - kURIPort) << 4 | length;
+            published.store(sent + count, std::memory_order_release);
 
-    memcpy(ptr + 1, path, length);
+            now = Clock::now();
 
-    ptr += 1 + length;
+            std::fill_n(sentTimes.begin() + static_cast<ptrdiff_t>(sent), count, now);
 
-    // End of option marker (1 byte)
-    *ptr = 0xFF;
+            passert(gateway.socket.send(requests.data(), count * 32), "Failed to send the CoAP request messages.");
 
-    ptr += 1;
+            sent += count;
+        }
+    });
 
-    // Payload data (4 bytes)
-    *reinterpret_cast<uint32_t*>(ptr) = moisture;
+    // Replies are received on the calling thread
+    std::vector<bool> replied(trials);
 
-    ptr += sizeof(uint32_t);
+    auto reader = makeGatewayReader();
 
-    passert(ptr - buffer == 32, "Check the request size.");
-}
+    size_t received = 0, oldest = 0;
 
-///
-/// Send a CoAP request message to the gateway device and receive the translated HTTP request message
-///
-/// @param request The CoAP request message
-/// @param response A non-null buffer that stores the translated HTTP request message on return
-/// @param length The number of bytes that the response buffer can hold
-///
-void Controller::sendRecvCoAPMessage(uint8_t (&request)[32], uint8_t* response, size_t length)
-{
-    passert(this->sockets[kGateway]->send(request, sizeof(request)), "Failed to send the CoAP request message.");
+    LoadResult result = { ExecutionTimeMeasurer::Result(trials), ExecutionTimeMeasurer::Result(trials), {}, {}, {}, {}, 0, 0 };
 
-    passert(this->sockets[kGateway]->receiveWithLength(response, length), "Failed to receive the HTTP message.");
-}
+    auto match = [&](const HTTPRequestView& reply) -> void
+    {
+        auto now = Clock::now();
 
-///
-/// Send a CoAP request message to the gateway device and receive the translated HTTP request message conveniently
-///
-void Controller::sendRecvCoAPMessageOnce()
-{
-    uint8_t request[32] = {}, response[64] = {};
+        size_t sent = published.load(std::memory_order_acquire);
 
-    this->makeCoAPRequestMessage(request, 100);
+        while (oldest < sent && replied[oldest])
+        {
+            oldest += 1;
+        }
 
-    this->sendRecvCoAPMessage(request, response, 54);
+        size_t request = getHTTPRequestTag(reply);
 
-    status("Received a HTTP request message:");
+        if (request >= sent || replied[request])
+        {
+            passert(oldest < sent, "Received more HTTP messages than CoAP requests.");
 
-    printf("%s\n", response);
-}
+            request = oldest;
 
-///
-/// Send multiple CoAP request messages and receive translated HTTP request messages to measure the round trip time in nanoseconds
-///
-/// @param trials Specify the number of trails
-/// @param delayMS Specify the amount of time in milliseconds to wait until the next trial
-/// @return The experiment result.
-///
-ExecutionTimeMeasurer::Result Controller::sendRecvCoAPMessages(size_t trials, uint64_t delayMS)
-{
-    uint8_t request[32], response[64];
+            result.untagged += 1;
+        }
+        else if (request != oldest)
+        {
+            result.reordered += 1;
+        }
 
-    Controller::makeCoAPRequestMessage(request, 100);
+        replied[request] = true;
 
-    return ExecutionTimeMeasurer{}(trials, std::chrono::milliseconds(delayMS), &Controller::sendRecvCoAPMessage, this, request, response, 54);
-}
+        repliedTimes[request] = now;
 
-///
-/// Run the gateway experiment
-///
-/// @param trials Specify the number of trails
-/// @param delayMS Specify the amount of time in milliseconds to wait until the next trial
-///
-void Controller::runGatewayExperiment(size_t trials, uint64_t delayMS)
-{
-    printf("Running the gateway experiment...\n");
+        received += 1;
+    };
 
-    printf("\tTrials = %zu; Delay = %llu milliseconds.\n", trials, delayMS);
+    while (received < trials)
+    {
+        receiveHTTPRequests(gateway.socket, reader, match);
+    }
 
-    auto result = this->sendRecvCoAPMessages(trials, delayMS);
+    sender.join();
 
-    printf("Execution time:\n");
+    for (size_t index = 0; index < trials; index += 1)
+    {
+        auto intended = start + schedule[index];
 
-    printf("- Min = %llu nanoseconds.\n", result.min());
+        result.latencies.durations.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(repliedTimes[index] - intended).count());
 
-    printf("- Max = %llu nanoseconds.\n", result.max());
+        result.serviceTimes.durations.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(repliedTimes[index] - sentTimes[index]).count());
 
-    printf("- Med = %llu nanoseconds.\n", result.medium());
+        result.maxLag = std::max(result.maxLag, std::chrono::duration_cast<std::chrono::nanoseconds>(sentTimes[index] - intended));
 
-    printf("- Avg = %.2f nanoseconds.\n", result.mean());
+        result.elapsed = std::max(result.elapsed, std::chrono::duration_cast<std::chrono::nanoseconds>(repliedTimes[index] - start));
+    }
 
-    printf("- Std = %.2f nanoseconds.\n", result.sd());
+    result.scheduled = schedule.back() - schedule.front();
+
+    result.sending = sentTimes.back() - sentTimes.front();
+
+    return result;
 }
 
 ///
-/// Receive 15-byte garbage data from the FastModels at the beginning
+/// Run the open-loop gateway experiment
 ///
-/// @param index The index of the socket from which to receive garbage data
+/// @param gateway The gateway device
+/// @param trials Specify the number of requests
+/// @param rate Specify the target number of requests per second
+/// @param arrival Specify the process that spaces requests
+/// @note The calling thread is pinned to the processor designated for the gateway device.
 ///
-void Controller::receiveGarbageDataFromFastModels(SocketIndex index)
+void Controller::runOpenLoopGatewayExperiment(const Device& gateway, size_t trials, double rate, Arrival arrival)
 {
-    uint8_t buffer[16] = {};
+    pinReceiverThread(gateway);
 
-    const char* name = SocketIndex2String(index);
+    printf("Running the open-loop gateway experiment on the %s device...\n", gateway.name.c_str());
 
-    pinfo("Receiving 15-byte garbage data from the %s device emulated by the ARM FastModels.", name);
+    printf("\tRequests = %zu; Target rate = %.2f requests per second; Arrival = %s.\n", trials, rate, Arrival2String(arrival));
 
-    passert(this->sockets[index], "The socket to the %s device does not exist.", name);
+    auto result = sendRecvCoAPMessagesOpenLoop(gateway, trials, rate, arrival);
 
-    if (this->sockets[index]->receiveWithLength(buffer, 15))
-    {
-        pinfo("Received 15-byte garbage data from the %s device.", name);
-    }
-    else
+    // Rates are measured over the gaps between the first and the last request
+    auto perSecond = [&](std::chrono::nanoseconds duration) -> double
     {
-        pwarning("Failed to receive the garbage data from the %s device.", name);
+        return duration.count() == 0 ? 0 : static_cast<double>(trials - 1) / std::chrono::duration<double>(duration).count();
+    };
+
+    printf("Scheduled rate = %.2f requests per second.\n", perSecond(result.scheduled));
+
+    printf("Achieved rate = %.2f requests per second (%.1f%% of the target); Max send lag = %" PRId64 " nanoseconds.\n",
+           perSecond(result.sending), perSecond(result.sending) / rate * 100, static_cast<int64_t>(result.maxLag.count()));
 
-        pwarning("The controller may not function properly.");
+    printf("Throughput = %.2f replies per second over %.3f seconds.\n",
+           static_cast<double>(trials) / std::chrono::duration<double>(result.elapsed).count(), std::chrono::duration<double>(result.elapsed).count());
+
+    printf("Replies = %zu reordered, %zu matched in order without a tag.\n", result.reordered, result.untagged);
+
+    printf("Latency from the intended send time (from the actual send time):\n");
+
+    static constexpr std::pair<const char*, double> kPercentiles[] = { { "P50", 0.5 }, { "P90", 0.9 }, { "P99", 0.99 }, { "P99.9", 0.999 } };
+
+    for (const auto& [name, fraction] : kPercentiles)
+    {
+        printf("- %-5s = %" PRIu64 " (%" PRIu64 ") nanoseconds.\n", name, result.latencies.percentile(fraction), result.serviceTimes.percentile(fraction));
     }
+
+    printf("- Max   = %" PRIu64 " (%" PRIu64 ") nanoseconds.\n", result.latencies.max(), result.serviceTimes.max());
+
+    printf("- Avg   = %.2f (%.2f) nanoseconds.\n", result.latencies.mean(), result.serviceTimes.mean());
 }
 
 /// Run the controller
 int Controller::run()
 {
-    std::thread sender(&Controller::sender, this);
+    this->devices.forEach([&](Device& device) -> void { this->configureReceiveOptions(device); });
+
+    // One sender thread for each device, and one receiver thread for each monitor and actuator device if receives are not multiplexed
+    this->devices.forEach([&](Device& device) -> void { this->start(device); });
 
-    std::thread mReceiver, aReceiver;
+    // The supervisor thread reconnects to devices that are disconnected
+    std::thread supervisor(&Controller::supervisor, this);
 
-    if (this->sockets[SocketIndex::kMonitor])
+    // The scheduler thread sends the commands scheduled by the user
+    std::thread scheduler(&Controller::scheduler, this);
+
+    std::vector<std::thread> receivers;
+
+    if (this->options.transport == Transport::kIOURing)
     {
-        mReceiver = std::thread(&Controller::receiver, this, SocketIndex::kMonitor);
+        // A single io_uring thread serves all monitor and actuator devices
+        receivers.emplace_back(&Controller::receiverWithIOURing, this);
     }
-
-    if (this->sockets[SocketIndex::kActuator])
+    else if (this->options.reactor)
     {
-        aReceiver = std::thread(&Controller::receiver, this, SocketIndex::kActuator);
+        // A single reactor thread serves all monitor and actuator devices
+        receivers.emplace_back(&Controller::reactor, this);
     }
 
-    if (this->sockets[SocketIndex::kGateway])
+    // The acceptor thread attaches devices that connect to the controller
+    if (!this->listeners.empty())
     {
-        this->receiveGarbageDataFromFastModels(SocketIndex::kGateway);
+        receivers.emplace_back(&Controller::acceptor, this);
     }
 
     // Wait for the user command
@@ -455,57 +2667,255 @@ int Controller::run()
         }
         else if (command == "soil")
         {
-            if (args.size() != 2)
+            if (args.size() != 2 && args.size() != 3)
             {
-                printf("Usage: soil level\n");
+                printf("Usage: soil level [device]\n");
+
+                printf("e.g. `soil 30` to set the moisture level to 30%% on all monitor devices.\n");
 
-                printf("e.g. `soil 30` to set the moisture level to 30%%.\n");
+                printf("     `soil 30 2` to set the moisture level to 30%% on device #2.\n");
             }
             else
             {
-                this->queue.offer(Command::changeSoilMoisture(std::stoi(args[1])));
+                this->enqueue(Command::changeSoilMoisture(std::stoi(args[1])), args, 2);
             }
         }
         else if (command == "water")
         {
-            if (args.size() != 2)
+            if (args.size() != 2 && args.size() != 3)
             {
-                printf("Usage: water status\n");
+                printf("Usage: water status [device]\n");
 
-                printf("e.g. `water 1` to fill the bottle with water.\n");
+                printf("e.g. `water 1` to fill the bottle with water on all actuator devices.\n");
 
-                printf("     `water 0` to empty the bottle.\n");
+                printf("     `water 0 1` to empty the bottle on device #1.\n");
             }
             else
             {
-                this->queue.offer(Command::changeWaterStatus(std::stoi(args[1])));
+                this->enqueue(Command::changeWaterStatus(std::stoi(args[1])), args, 2);
             }
         }
         else if (command == "dry")
         {
-            this->queue.offer(Command::sendDrySoilAlertToActuatorDevice());
+            this->enqueue(Command::sendDrySoilAlertToActuatorDevice(), args, 1);
         }
         else if (command == "wet")
         {
-            this->queue.offer(Command::sendWetSoilAlertToActuatorDevice());
+            this->enqueue(Command::sendWetSoilAlertToActuatorDevice(), args, 1);
+        }
+        else if (command == "devices")
+        {
+            this->devices.forEach([](const Device& device) -> void
+            {
+                uint32_t epoch = device.epoch.load(std::memory_order_acquire);
+
+                printf("%s: Role = %s; Descriptor = %d; Status = %s; Reconnections = %u.\n",
+                       device.name.c_str(), Role2String(device.role), device.socket.getDescriptor(),
+                       epoch % 2 == 0 ? "Connected" : "Disconnected", epoch / 2);
+            });
+        }
+        else if (command == "routes")
+        {
+            this->printRoutes();
+        }
+        else if (command == "queues")
+        {
+            this->devices.forEach([](const Device& device) -> void
+            {
+                for (size_t lane = 0; lane < kLaneCount; lane += 1)
+                {
+                    const CommandQueue::Lane& queue = device.queue.getLane(lane);
+
+                    auto statistics = queue.getStatistics();
+
+                    printf("%s (%s): %zu of %zu pending messages; Policy = %s%s; Sent = %" PRIu64 "; Dropped = %" PRIu64 " oldest, %" PRIu64 " newest; "
+                           "Coalesced = %" PRIu64 "; Blocked = %" PRIu64 "; High watermarks = %" PRIu64 ".\n",
+                           device.name.c_str(), Lane2String(static_cast<Lane>(lane)), queue.getCount(), queue.getCapacity(), QueueOptions::Policy2String(queue.getPolicy()),
+                           queue.isCoalescing() && queue.getPolicy() != QueueOptions::kCoalesce ? " with coalescing" : "",
+                           statistics.dequeued, statistics.droppedOldest, statistics.droppedNewest, statistics.coalesced, statistics.blocked, statistics.highWatermarks);
+                }
+            });
+        }
+        else if (command == "lanes")
+        {
+            printf("Scheduling = %s.\n", LaneOptions::Scheduling2String(this->options.lanes.scheduling));
+
+            this->devices.forEach([](const Device& device) -> void
+            {
+                for (size_t lane = 0; lane < kLaneCount; lane += 1)
+                {
+                    const LaneLatency& latency = device.latencies[lane];
+
+                    uint64_t count = latency.count.load(std::memory_order_relaxed);
+
+                    double mean = count == 0 ? 0 : static_cast<double>(latency.total.load(std::memory_order_relaxed)) / static_cast<double>(count);
+
+                    printf("%s (%s): Weight = %u; Sent = %" PRIu64 "; Mean latency = %.3f us; Max latency = %.3f us.\n",
+                           device.name.c_str(), Lane2String(static_cast<Lane>(lane)), device.queue.getWeight(lane), count,
+                           mean / 1000, static_cast<double>(latency.maximum.load(std::memory_order_relaxed)) / 1000);
+                }
+            });
+        }
+        else if (command == "every")
+        {
+            auto period = args.size() >= 3 ? parseDuration(args[1]) : std::nullopt;
+
+            if (!period || period->count() == 0)
+            {
+                printf("Usage: every interval command [args...]\n");
+
+                printf("where `interval` is a positive number of milliseconds with an optional unit `ms`, `s` or `m`;\n");
+
+                printf("      `command` is `soil`, `water`, `dry` or `wet` along with its arguments.\n");
+
+                printf("e.g. `every 200ms soil 30` to set the moisture level to 30%% on all monitor devices every 200 milliseconds.\n");
+            }
+            else if (auto identifier = this->schedule(std::chrono::steady_clock::now() + *period, *period, args, 2))
+            {
+                printf("Scheduled timer %" PRIu64 ".\n", *identifier);
+            }
+        }
+        else if (command == "at")
+        {
+            auto deadline = args.size() >= 3 ? parseTimePoint(args[1]) : std::nullopt;
+
+            if (!deadline)
+            {
+                printf("Usage: at time command [args...]\n");
+
+                printf("where `time` is `+` followed by a delay such as `+5s`, or the local time of day in the format of `HH:MM:SS`;\n");
+
+                printf("      `command` is `soil`, `water`, `dry` or `wet` along with its arguments.\n");
+
+                printf("e.g. `at +5s water 0` to empty the bottle on all actuator devices in 5 seconds.\n");
+            }
+            else if (auto identifier = this->schedule(*deadline, TimerTick::zero(), args, 2))
+            {
+                printf("Scheduled timer %" PRIu64 ".\n", *identifier);
+            }
+        }
+        else if (command == "timers")
+        {
+            this->printTimers();
+        }
+        else if (command == "cancel")
+        {
+            char* end = nullptr;
+
+            TimerID identifier = args.size() == 2 ? strtoull(args[1].c_str(), &end, 10) : 0;
+
+            if (end == nullptr || *end != '\0')
+            {
+                printf("Usage: cancel timer\n");
+
+                printf("where `timer` is the identifier printed by `every`, `at` or `timers`.\n");
+            }
+            else
+            {
+                bool cancelled;
+
+                {
+                    std::lock_guard<std::mutex> guard(this->timersLock);
+
+                    cancelled = this->timers.cancel(identifier);
+                }
+
+                if (cancelled)
+                {
+                    printf("Cancelled timer %" PRIu64 ".\n", identifier);
+                }
+                else
+                {
+                    printf("No timer has the identifier %" PRIu64 ".\n", identifier);
+                }
+            }
         }
         else if (command == "coap")
         {
-            this->sendRecvCoAPMessageOnce();
+            if (const Device* gateway = this->findDevice(args, 1, Role::kGateway))
+            {
+                sendRecvCoAPMessageOnce(*gateway);
+            }
         }
         else if (command == "gateway")
         {
-            if (args.size() != 3)
+            // The optional keyword that enables validation comes last
+            bool validate = args.size() > 2 && args.back() == "validate";
+
+            if (validate)
+            {
+                args.pop_back();
+            }
+
+            if (args.size() != 3 && args.size() != 4)
             {
-                printf("Usage: gateway trials delay\n");
+                printf("Usage: gateway trials delay [device] [validate]\n");
 
                 printf("where `trials` specify the number of trials;\n");
 
-                printf("      `delay` specify the amount of time in milliseconds between each trial.\n");
+                printf("      `delay` specify the amount of time in milliseconds between each trial;\n");
+
+                printf("      `device` specify the gateway device (the first gateway device by default);\n");
+
+                printf("      `validate` compares each reply with the expected HTTP request message.\n");
             }
-            else
+            else if (const Device* gateway = this->findDevice(args, 3, Role::kGateway))
+            {
+                runGatewayExperiment(*gateway, std::stoll(args[1]), std::stoll(args[2]), validate);
+            }
+        }
+        else if (command == "pipeline")
+        {
+            size_t trials = args.size() >= 3 ? strtoull(args[1].c_str(), nullptr, 10) : 0;
+
+            size_t window = args.size() >= 3 ? strtoull(args[2].c_str(), nullptr, 10) : 0;
+
+            if (args.size() > 4 || trials == 0 || window == 0 || window > kMaxPipelineWindow)
+            {
+                printf("Usage: pipeline trials window [device]\n");
+
+                printf("where `trials` specify the number of requests;\n");
+
+                printf("      `window` specify the maximum number of requests in flight, from 1 to %zu;\n", kMaxPipelineWindow);
+
+                printf("      `device` specify the gateway device (the first gateway device by default).\n");
+            }
+            else if (const Device* gateway = this->findDevice(args, 3, Role::kGateway))
+            {
+                runPipelinedGatewayExperiment(*gateway, trials, window);
+            }
+        }
+        else if (command == "load")
+        {
+            size_t trials = args.size() >= 4 ? strtoull(args[1].c_str(), nullptr, 10) : 0;
+
+            double rate = args.size() >= 4 ? strtod(args[2].c_str(), nullptr) : 0;
+
+            std::optional<Arrival> arrival;
+
+            if (args.size() >= 4)
+            {
+                for (Arrival candidate : { kConstant, kPoisson })
+                {
+                    arrival = args[3] == Arrival2String(candidate) ? candidate : arrival;
+                }
+            }
+
+            if (args.size() > 5 || trials < 2 || !(rate > 0) || !arrival)
+            {
+                printf("Usage: load trials rate arrival [device]\n");
+
+                printf("where `trials` specify the number of requests, at least 2;\n");
+
+                printf("      `rate` specify the target number of requests per second;\n");
+
+                printf("      `arrival` is `constant` for evenly spaced requests or `poisson` for exponentially distributed gaps;\n");
+
+                printf("      `device` specify the gateway device (the first gateway device by default).\n");
+            }
+            else if (const Device* gateway = this->findDevice(args, 4, Role::kGateway))
             {
-                this->runGatewayExperiment(std::stoll(args[1]), std::stoll(args[2]));
+                runOpenLoopGatewayExperiment(*gateway, trials, rate, *arrival);
             }
         }
         else
@@ -12,87 +12,382 @@
 #ifndef Controller_hpp
 #define Controller_hpp
 
-#include "LinkedBlockingQueue.hpp"
+#include "MPSCRingQueue.hpp"
+#include "LaneQueue.hpp"
 #include "StreamSocket.hpp"
 #include "Message.hpp"
 #include "Experiments.hpp"
+#include "Debug.hpp"
+#include "Reactor.hpp"
+#include "IOURing.hpp"
+#include "FrameReader.hpp"
+#include "DeviceRegistry.hpp"
+#include "RoutingTable.hpp"
+#include "Endpoint.hpp"
+#include "Connector.hpp"
+#include "Doorbell.hpp"
+#include "Futex.hpp"
+#include "ListeningSocket.hpp"
+#include "TimerWheel.hpp"
+#include "HTTPRequestReader.hpp"
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
 
 class Controller
 {
-private:
-    /// Socket indices
-    enum SocketIndex: size_t
+public:
+    /// Transports used to exchange messages with the monitor and actuator devices
+    enum Transport
+    {
+        /// Blocking system calls issued by the sender and receiver threads
+        kBlocking,
+
+        /// Batched sends and receives submitted to io_uring
+        kIOURing,
+    };
+
+    /// Roles of devices
+    enum Role: size_t
     {
         kMonitor  = 0,
         kActuator = 1,
         kGateway  = 2,
     };
 
-    /// Get the string representation of the given socket index
-    static inline const char* SocketIndex2String(SocketIndex index)
+    /// The number of roles
+    static constexpr size_t kRoleCount = 3;
+
+    /// Get the string representation of the given role
+    static inline const char* Role2String(Role role)
     {
-        switch (index)
+        switch (role)
         {
-            case SocketIndex::kMonitor:
+            case Role::kMonitor:
                 return "Monitor";
 
-            case SocketIndex::kActuator:
+            case Role::kActuator:
                 return "Actuator";
 
-            case SocketIndex::kGateway:
+            case Role::kGateway:
                 return "Gateway";
         }
+
+        return "Unknown";
     }
 
+    /// Priority lanes of commands sent to a device
+    enum Lane: size_t
+    {
+        /// Commands issued by the operator and acknowledgements that close a control loop
+        kControl = 0,
+
+        /// Messages relayed from one device to another
+        kRelay = 1,
+
+        /// Traffic generated in volume, which yields to the other lanes
+        kBulk = 2,
+    };
+
+    /// The number of lanes
+    static constexpr size_t kLaneCount = 3;
+
+    /// Get the string representation of the given lane
+    static inline const char* Lane2String(Lane lane)
+    {
+        switch (lane)
+        {
+            case Lane::kControl:
+                return "Control";
+
+            case Lane::kRelay:
+                return "Relay";
+
+            case Lane::kBulk:
+                return "Bulk";
+        }
+
+        return "Unknown";
+    }
+
+    /// The routing table that decides where messages are relayed
+    using Router = RoutingTable<Role>;
+
+    /// Options that tune how the controller receives messages from a device
+    struct DeviceOptions
+    {
+        /// `true` if the thread that receives from the device spins on a non-blocking descriptor,
+        /// `false` if the thread sleeps in the kernel until data arrives
+        /// @note This option is ignored for monitor and actuator devices if their messages are multiplexed.
+        bool spin = false;
+
+        /// The index of the processor to which the thread that receives from the device is pinned
+        /// @note This option is ignored for monitor and actuator devices if their messages are multiplexed.
+        std::optional<uint32_t> cpu = std::nullopt;
+
+        /// `true` if commands sent to the device while it is disconnected are dropped,
+        /// `false` if they wait in the queue of the device until it is reconnected
+        /// @note Producers block once the queue is full if commands wait in the queue and the queue policy is `kBlock`.
+        bool dropOffline = false;
+
+        /// The bound of each lane of commands sent to the device and what producers do once a lane is full
+        QueueOptions queue = {};
+    };
+
+    /// Options that tune how the controller communicates with devices
+    struct Options
+    {
+        /// `true` if a single reactor thread receives messages from all devices,
+        /// `false` if each device is served by a dedicated receiver thread
+        /// @note This option is ignored if the transport is `kIOURing`.
+        bool reactor;
+
+        /// The transport used to exchange messages with monitor and actuator devices
+        Transport transport;
+
+        /// How the sender thread of each device picks commands from the lanes
+        LaneOptions lanes = {};
+    };
+
+private:
     /// Command
     struct Command
     {
         /// Message to be sent
         Message message;
 
-        /// Index of the destination socket
-        SocketIndex index;
+        /// Role of the destination devices
+        Role role;
+
+        /// The lane assigned by the producer of the command
+        Lane lane;
+
+        /// The point in time at which the command is produced
+        std::chrono::steady_clock::time_point produced;
 
         /// Create a command
-        Command(Message message, SocketIndex index) : message(message), index(index) {}
+        Command(Message message, Role role, Lane lane) : message(message), role(role), lane(lane), produced(std::chrono::steady_clock::now()) {}
 
         static Command changeSoilMoisture(UInt32 level)
         {
-            return { Message::changeSoilMoisture(level), SocketIndex::kMonitor };
+            return { Message::changeSoilMoisture(level), Role::kMonitor, Lane::kControl };
         }
 
         static Command changeWaterStatus(bool hasWater)
         {
-            return { Message::changeWaterStatus(hasWater), SocketIndex::kActuator };
+            return { Message::changeWaterStatus(hasWater), Role::kActuator, Lane::kControl };
         }
 
-        static Command relayMessageToSensorDevice(const Message& message)
+        static Command sendDrySoilAlertToActuatorDevice()
         {
-            return { message, SocketIndex::kMonitor };
+            return { Message::soilDryAlert(), Role::kActuator, Lane::kControl };
         }
 
-        static Command relayMessageToActuatorDevice(const Message& message)
+        static Command sendWetSoilAlertToActuatorDevice()
         {
-            return { message, SocketIndex::kActuator };
+            return { Message::soilWetAlert(), Role::kActuator, Lane::kControl };
         }
 
-        static Command sendDrySoilAlertToActuatorDevice()
+        ///
+        /// Assigns a coalescing key to commands that set the absolute state of a device
+        ///
+        /// @note Only the latest pending state command of each type matters to the device,
+        ///       whereas alerts must arrive in order and as many times as they are relayed.
+        ///
+        struct Coalescer
         {
-            return { Message::soilDryAlert(), SocketIndex::kActuator };
+            /// The number of distinct coalescing keys
+            static constexpr size_t kKeyCount = 2;
+
+            /// Get the coalescing key of the given command
+            static std::optional<size_t> getKey(const Command& command)
+            {
+                switch (command.message.type)
+                {
+                    case Message::kChangeSoilMoisture:
+                        return 0;
+
+                    case Message::kChangeWaterStatus:
+                        return 1;
+
+                    default:
+                        return std::nullopt;
+                }
+            }
+        };
+    };
+
+    /// A command fired by a timer
+    struct ScheduledCommand
+    {
+        /// The command to send each time the timer fires
+        /// @note The command is sent in the bulk lane, so scheduled traffic never delays commands typed by the user.
+        Command command;
+
+        /// The identifier of the destination device, or `std::nullopt` to send the command to all devices of its destination role
+        std::optional<DeviceID> destination;
+
+        /// The user command that produces the command
+        std::string description;
+    };
+
+    /// The clock that drives timers
+    using TimerClock = std::chrono::steady_clock;
+
+    /// The duration of a tick of the timer wheel
+    using TimerTick = std::chrono::milliseconds;
+
+    /// Bounded queues of commands, one for each lane
+    using CommandQueue = LaneQueue<Command, kLaneCount, Command::Coalescer>;
+
+    /// The latency of commands in a lane from the moment they are produced until they are sent
+    /// @note Only the sender thread of the device updates the counters.
+    struct LaneLatency
+    {
+        /// The number of commands sent
+        std::atomic<uint64_t> count = 0;
+
+        /// The sum of the latency of all commands sent in nanoseconds
+        std::atomic<uint64_t> total = 0;
+
+        /// The maximum latency in nanoseconds
+        std::atomic<uint64_t> maximum = 0;
+
+        /// Record the latency of a command that has been sent
+        void record(std::chrono::nanoseconds latency)
+        {
+            auto value = static_cast<uint64_t>(latency.count());
+
+            this->count.store(this->count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+            this->total.store(this->total.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+
+            this->maximum.store(std::max(this->maximum.load(std::memory_order_relaxed), value), std::memory_order_relaxed);
         }
+    };
 
-        static Command sendWetSoilAlertToActuatorDevice()
+    /// An emulated board connected to the controller
+    struct Device
+    {
+        /// The device identifier assigned by the registry
+        DeviceID identifier;
+
+        /// The role of the device
+        Role role;
+
+        /// The endpoint at which the controller reconnects to the device
+        Endpoint endpoint;
+
+        /// The socket used to communicate with the device
+        /// @note The descriptor remains the same after the device is reconnected.
+        StreamSocket socket;
+
+        /// Options that tune how the controller receives messages from the device
+        DeviceOptions options;
+
+        /// The queues of commands waiting to be sent to the device
+        /// @note Receiver threads and the command line interface produce commands for the sender thread of the device,
+        ///       so a device that stalls delays only the messages bound for itself.
+        CommandQueue queue;
+
+        /// The latency of commands sent to the device in each lane
+        std::array<LaneLatency, kLaneCount> latencies;
+
+        /// The human-readable name of the device
+        std::string name;
+
+        /// The number of times the connection to the device has been lost or re-established
+        /// @note The device is connected if the epoch is even.
+        ///       Threads that observe a failure report it along with the epoch they started with,
+        ///       so a failure on a connection that has already been replaced is ignored.
+        std::atomic<uint32_t> epoch = 0;
+
+        /// The futex on which threads sleep until the device is reconnected
+        Futex reconnected;
+
+        /// The index of the listener that has accepted the device, or `std::nullopt` if the controller connects to the device
+        /// @note The controller does not reconnect to an accepted device. Instead, the device reconnects to the same listener.
+        std::optional<size_t> listener;
+
+        /// Routing decisions for messages received from the device
+        Router::Routes routes;
+
+        /// Create a device
+        Device(DeviceID identifier, Role role, Endpoint endpoint, StreamSocket socket, DeviceOptions options, const LaneOptions& lanes, std::optional<size_t> listener, const Router& router)
+            : identifier(identifier), role(role), endpoint(std::move(endpoint)), socket(std::move(socket)), options(options),
+              queue(options.queue, lanes), name(fmt::format("{} #{}", Role2String(role), identifier)), listener(listener), routes(router.compile(identifier, role)) {}
+
+        ///
+        /// Check whether the device is connected
+        ///
+        /// @return `true` if the device is connected, `false` if it is being reconnected.
+        ///
+        [[nodiscard]]
+        bool isConnected() const
         {
-            return { Message::soilWetAlert(), SocketIndex::kActuator };
+            return this->epoch.load(std::memory_order_acquire) % 2 == 0;
         }
     };
 
+    /// The receive buffer of a connection
+    using Connection = FrameReader<Message>;
+
+    /// A socket on which the controller accepts connections from devices
+    struct Listener
+    {
+        /// The socket that accepts connections
+        ListeningSocket socket;
+
+        /// The address and the options applied to each accepted device
+        Endpoint endpoint;
+
+        /// The role of each accepted device, or `std::nullopt` if each device identifies itself with its first message
+        std::optional<Role> role;
+    };
+
 private:
-    /// Sockets used to communicate with the moisture, actuator and gateway devices
-    std::optional<StreamSocket> sockets[3];
+    /// Devices connected to the controller
+    DeviceRegistry<Device, kRoleCount> devices;
+
+    /// Options specified by the user
+    Options options;
 
-    /// Command queue for the sender thread
-    LinkedBlockingQueue<Command> queue;
+    /// The routing rules specified by the user
+    Router routingTable;
+
+    /// Sockets on which the controller accepts connections from devices
+    std::vector<Listener> listeners;
+
+    /// Sender and receiver threads of all devices
+    std::vector<std::thread> threads;
+
+    /// The lock that serializes the creation of threads
+    std::mutex threadsLock;
+
+    /// The futex that wakes up the supervisor thread once a device is disconnected
+    Futex disconnections;
+
+#if DOORBELL_AVAILABLE
+    /// The doorbell that wakes up the thread that multiplexes receives once a device is reconnected
+    Doorbell doorbell;
+#endif
+
+    /// Commands scheduled by the user, one tick per millisecond since the controller is created
+    TimerWheel<ScheduledCommand> timers;
+
+    /// The lock that protects the timer wheel
+    std::mutex timersLock;
+
+    /// The futex that wakes up the scheduler thread once a timer is scheduled
+    Futex timersChanged;
+
+    /// The point in time that corresponds to the first tick of the timer wheel
+    TimerClock::time_point timersStart = TimerClock::now();
+
+    /// The number of periodic firings skipped because the scheduler thread fell behind
+    /// @note The counter is protected by the timer lock.
+    uint64_t timersSkipped = 0;
 
     //
     // MARK: - Constructor & Destructor
@@ -100,34 +395,246 @@ private:
 
 public:
     ///
-    /// Create the controller with device sockets
+    /// Create the controller without any device
     ///
-    /// @param monitor An optional socket to communicate with the monitor device
-    /// @param actuator An optional socket to communicate with the actuator device
-    /// @param gateway An optional socket to communicate with the gateway device
+    /// @param options Options that tune how the controller communicates with devices
+    /// @param routingTable The rules that decide where messages are relayed
     ///
-    Controller(std::optional<StreamSocket> monitor, std::optional<StreamSocket> actuator, std::optional<StreamSocket> gateway)
-    {
-        this->sockets[SocketIndex::kMonitor] = std::move(monitor);
+    explicit Controller(Options options, Router routingTable = makeDefaultRoutingTable()) : options(options), routingTable(std::move(routingTable)) {}
 
-        this->sockets[SocketIndex::kActuator] = std::move(actuator);
+    ///
+    /// Create the routing table that relays alerts from monitor devices to actuator devices and acknowledgements back
+    ///
+    /// @return The default routing table.
+    ///
+    static Router makeDefaultRoutingTable();
 
-        this->sockets[SocketIndex::kGateway] = std::move(gateway);
-    }
+    ///
+    /// Print the routing decisions for each device
+    ///
+    void printRoutes() const;
+
+    ///
+    /// Add a device to the controller
+    ///
+    /// @param role The role of the device
+    /// @param endpoint The endpoint at which the controller reconnects to the device
+    /// @param socket A socket connected to the device from which the preamble has been received
+    /// @param deviceOptions Options that tune how the controller receives messages from the device
+    /// @return The identifier of the device on success, `std::nullopt` if the controller cannot accept more devices.
+    /// @note Devices must be added before the controller runs.
+    ///
+    std::optional<DeviceID> addDevice(Role role, const Endpoint& endpoint, StreamSocket socket, DeviceOptions deviceOptions);
+
+    ///
+    /// Accept connections from devices on the given endpoint
+    ///
+    /// @param role The role of each accepted device, or `std::nullopt` if each device identifies itself with its first message
+    /// @param endpoint The address on which to listen and the options applied to each accepted device
+    /// @throws SocketException if failed to listen on the given endpoint.
+    /// @note Listeners must be added before the controller runs.
+    ///
+    void addListener(std::optional<Role> role, const Endpoint& endpoint);
 
     //
     // MARK: - Background Threads
     //
 
+    ///
     /// The sender thread implementation
-    [[noreturn]] void sender();
+    ///
+    /// @param device The device to which the thread sends messages
+    ///
+    [[noreturn]] void sender(Device& device);
+
+    ///
+    /// The sender thread implementation that submits batched sends to io_uring
+    ///
+    /// @param device The device to which the thread sends messages
+    ///
+    [[noreturn]] void senderWithIOURing(Device& device);
 
     ///
     /// The receiver thread implementation
     ///
-    /// @param index The index of the socket from which to receive data
+    /// @param device The device from which to receive data
+    ///
+    void receiver(Device& device);
+
+    ///
+    /// The reactor thread implementation
     ///
-    void receiver(SocketIndex index);
+    /// @note The reactor thread multiplexes the sockets of all monitor and actuator devices,
+    ///       replacing the dedicated receiver thread of each device.
+    ///
+    void reactor();
+
+    ///
+    /// The receiver thread implementation that multiplexes sockets with io_uring receives
+    ///
+    /// @note The thread replaces the dedicated receiver thread of all monitor and actuator devices.
+    ///
+    void receiverWithIOURing();
+
+    ///
+    /// The acceptor thread implementation
+    ///
+    /// @note The acceptor thread accepts connections on all listeners, identifies the role of each device
+    ///       and attaches the device without blocking the other devices.
+    ///
+    [[noreturn]] void acceptor();
+
+    ///
+    /// Attach a device that has connected to a listener
+    ///
+    /// @param role The role of the device
+    /// @param listener The index of the listener that has accepted the device
+    /// @param socket A blocking socket connected to the device
+    /// @param message The message with which the device has identified itself, if any
+    /// @note A device that reconnects to the same listener takes over the disconnected device that has the same role.
+    ///
+    void attach(Role role, size_t listener, StreamSocket socket, std::optional<Message> message);
+
+    ///
+    /// Identify the role of a device from the first message it sends
+    ///
+    /// @param message The first message received from the device
+    /// @return The role on success, `std::nullopt` if the message does not report a user stack.
+    ///
+    static std::optional<Role> identify(const Message& message);
+
+    ///
+    /// The scheduler thread implementation
+    ///
+    /// @note The scheduler thread sleeps until the next timer expires, collects the commands of all expired timers
+    ///       and then submits them to the queues of their destination devices without holding the timer lock.
+    ///       A command is dropped for a device whose queue is full, so a device that is offline cannot stall the others.
+    ///
+    [[noreturn]] void scheduler();
+
+    ///
+    /// Schedule the command that the user specifies in a command
+    ///
+    /// @param deadline The point in time at which the command is sent for the first time
+    /// @param period The amount of time between two firings, or zero to send the command once
+    /// @param args The arguments of the user command
+    /// @param position The position of the scheduled command in the arguments
+    /// @return The identifier of the timer on success, `std::nullopt` if the scheduled command is malformed.
+    ///
+    std::optional<TimerID> schedule(TimerClock::time_point deadline, TimerTick period, const std::vector<std::string>& args, size_t position);
+
+    ///
+    /// Print all scheduled commands
+    ///
+    void printTimers();
+
+    ///
+    /// Start the threads that serve the given device
+    ///
+    /// @param device A device that has been configured
+    /// @note Devices whose messages are multiplexed are picked up by the running multiplexing thread.
+    ///
+    void start(Device& device);
+
+    ///
+    /// The supervisor thread implementation
+    ///
+    /// @note The supervisor thread reconnects to each disconnected device that is not accepted by a listener with exponential backoff,
+    ///       receives the preamble again and then wakes up the threads that wait for the device.
+    ///       It also reports the queues that have crossed a watermark, so threads that enqueue commands never print.
+    ///
+    [[noreturn]] void supervisor();
+
+    ///
+    /// Report the queues that have crossed a watermark since the last report
+    ///
+    /// @param reported The number of times each lane of each device has reached the high and the low watermark at the last report,
+    ///                 indexed by device identifiers and updated on return
+    ///
+    void reportWatermarks(std::vector<std::array<std::pair<uint64_t, uint64_t>, kLaneCount>>& reported);
+
+    ///
+    /// Report that the connection to the given device is lost
+    ///
+    /// @param device The device whose connection is lost
+    /// @param epoch The epoch of the device when the caller started to use the connection
+    /// @note The report is ignored if the device has been disconnected or reconnected since the given epoch.
+    ///       Otherwise, the connection is shut down so that all threads blocked on it return,
+    ///       and the supervisor thread starts to reconnect to the device.
+    ///
+    void disconnect(Device& device, uint32_t epoch);
+
+    ///
+    /// Wait until the given device is connected
+    ///
+    /// @param device A device
+    /// @return The epoch of the device once it is connected.
+    ///
+    static uint32_t waitForConnection(Device& device);
+
+    ///
+    /// Validate the receive options of the given device and enable busy polling on its socket if requested
+    ///
+    /// @param device A device
+    /// @note The function must be called before any thread starts to use the socket.
+    ///
+    void configureReceiveOptions(Device& device);
+
+    ///
+    /// Pin the calling thread to the processor designated for the given device
+    ///
+    /// @param device The device from which the calling thread receives messages
+    ///
+    static void pinReceiverThread(const Device& device);
+
+    ///
+    /// Process a message received from a device
+    ///
+    /// @param device The device from which the message is received
+    /// @param message A message received from the device
+    /// @note The message is relayed according to the routes compiled from the routing table.
+    ///
+    void dispatch(const Device& device, const Message& message);
+
+    ///
+    /// Submit a command to the queues of all devices of its destination role
+    ///
+    /// @param command A command to send
+    /// @param wait Pass `false` to drop the command for each device whose queue is full instead of waiting for room
+    /// @note Commands sent to a role without any device are dropped.
+    ///
+    void enqueue(const Command& command, bool wait = true);
+
+    ///
+    /// Submit a command to the queue of the given device
+    ///
+    /// @param command A command to send
+    /// @param identifier The identifier of the destination device
+    /// @param wait Pass `false` to drop the command if the queue of the device is full instead of waiting for room
+    /// @note Commands sent to a device that does not exist or does not have the destination role are dropped.
+    ///
+    void enqueue(const Command& command, DeviceID identifier, bool wait = true);
+
+    ///
+    /// Submit a command to the device that the user refers to in a command
+    ///
+    /// @param command A command to send
+    /// @param args The arguments of the user command
+    /// @param position The position of the optional device identifier in the arguments
+    /// @note The command is sent to all devices of its destination role if the user does not specify an identifier.
+    ///
+    void enqueue(const Command& command, const std::vector<std::string>& args, size_t position);
+
+    ///
+    /// Find the device that the user refers to in a command
+    ///
+    /// @param args The arguments of the user command
+    /// @param position The position of the optional device identifier in the arguments
+    /// @param role The role that the device must have
+    /// @return The device on success, `nullptr` if the identifier is invalid or no device of the role exists.
+    /// @note The first device of the role is returned if the user does not specify an identifier.
+    ///
+    Device* findDevice(const std::vector<std::string>& args, size_t position, Role role) const;
 
     ///
     /// Print the controller status
@@ -140,55 +647,208 @@ public:
     // MARK: - CoAP-HTTP Gateway
     //
 
+    /// Splits the byte stream from the gateway device into translated HTTP request messages
+    using GatewayReader = HTTPRequestReader<>;
+
     ///
     /// Create a CoAP request message
     ///
     /// @param buffer A buffer that contains the CoAP message on return
     /// @param moisture The moisture level
+    /// @param identifier The message identifier
     ///
-    static void makeCoAPRequestMessage(uint8_t (&buffer)[32], uint32_t moisture);
+    static void makeCoAPRequestMessage(uint8_t (&buffer)[32], uint32_t moisture, uint16_t identifier = 0x4657);
 
     ///
     /// Send a CoAP request message to the gateway device and receive the translated HTTP request message
     ///
+    /// @param gateway The gateway device
     /// @param request The CoAP request message
-    /// @param response A non-null buffer that stores the translated HTTP request message on return
-    /// @param length The number of bytes that the response buffer can hold
+    /// @param reader The reader that receives messages from the gateway device
+    /// @return A view of the translated HTTP request message that remains valid until the reader receives more data.
     ///
-    void sendRecvCoAPMessage(uint8_t (&request)[32], uint8_t* response, size_t length);
+    static HTTPRequestView sendRecvCoAPMessage(const Device& gateway, uint8_t (&request)[32], GatewayReader& reader);
 
     ///
     /// Send a CoAP request message to the gateway device and receive the translated HTTP request message conveniently
     ///
-    void sendRecvCoAPMessageOnce();
+    /// @param gateway The gateway device
+    ///
+    static void sendRecvCoAPMessageOnce(const Device& gateway);
+
+    /// Counts the translated HTTP request messages that differ from the message expected for the CoAP request message
+    struct ValidationResult
+    {
+        /// The number of replies that differ from the expected message, including malformed ones
+        size_t mismatches = 0;
+
+        /// The number of replies that cannot be framed as an HTTP message
+        size_t malformed = 0;
+
+        /// The index of the first trial whose reply differs from the expected message
+        size_t firstTrial = 0;
+
+        /// The reason for which the reply of that trial is malformed, or `std::nullopt` if it is a well-formed message
+        std::optional<HTTPParseError> firstError;
+
+        /// The offset of the first byte that differs in the reply of that trial
+        size_t firstOffset = 0;
+
+        /// The expected and the received byte at that offset, or -1 if the message ends before the offset
+        int expected = -1, received = -1;
+    };
 
     ///
     /// Send multiple CoAP request messages and receive translated HTTP request messages to measure the round trip time in nanoseconds
     ///
+    /// @param gateway The gateway device
     /// @param trials Specify the number of trails
     /// @param delayMS Specify the amount of time in milliseconds to wait until the next trial
+    /// @param validation A non-null result to compare each reply with the expected message, `nullptr` to skip the comparison
     /// @return The experiment result.
+    /// @note To validate replies, each trial copies the framed reply into a slot preallocated for it, which holds one byte more than the expected message,
+    ///       and the replies are compared with the expected message after the last trial, so the comparison is not measured.
+    ///       A reply that cannot be framed as an HTTP message ends its trial as a mismatch,
+    ///       and the reader discards the bytes received so far to resynchronize with the next reply.
     ///
-    ExecutionTimeMeasurer::Result sendRecvCoAPMessages(size_t trials, uint64_t delayMS);
+    static ExecutionTimeMeasurer::Result sendRecvCoAPMessages(const Device& gateway, size_t trials, uint64_t delayMS, ValidationResult* validation = nullptr);
 
     ///
     /// Run the gateway experiment
     ///
+    /// @param gateway The gateway device
     /// @param trials Specify the number of trails
     /// @param delayMS Specify the amount of time in milliseconds to wait until the next trial
+    /// @param validate Pass `true` to check that each reply is the expected HTTP request message
+    /// @note The calling thread is pinned to the processor designated for the gateway device.
     ///
-    void runGatewayExperiment(size_t trials, uint64_t delayMS);
+    static void runGatewayExperiment(const Device& gateway, size_t trials, uint64_t delayMS, bool validate = false);
 
-    //
-    // MARK: - Main Controller
-    //
+    /// The result of a pipelined gateway experiment
+    struct PipelineResult
+    {
+        /// The latency of each request in nanoseconds from the moment it is sent until its reply is received
+        ExecutionTimeMeasurer::Result latencies;
+
+        /// The amount of time from the moment the first request is sent until the last reply is received
+        std::chrono::nanoseconds elapsed;
+
+        /// The number of replies received before the reply to an earlier request
+        size_t reordered;
+
+        /// The number of replies that do not carry the tag of an outstanding request and are therefore matched in order
+        size_t untagged;
+    };
+
+    /// The maximum number of outstanding requests in a pipelined gateway experiment
+    /// @note Replies to outstanding requests must fit in the socket buffers, since requests are sent without reading replies.
+    static constexpr size_t kMaxPipelineWindow = 1024;
 
     ///
-    /// Receive 15-byte garbage data from the FastModels at the beginning
+    /// Send multiple CoAP request messages without waiting for the translated HTTP request messages in between
     ///
-    /// @param index The index of the socket from which to receive garbage data
+    /// @param gateway The gateway device
+    /// @param trials Specify the number of requests
+    /// @param window Specify the maximum number of requests whose reply has not been received
+    /// @return The experiment result.
+    /// @note Each request carries its sequence number as the message identifier and the payload.
+    ///       The gateway copies the payload to the HTTP message, so replies are matched to requests by the payload,
+    ///       or to the oldest outstanding request if the payload does not identify an outstanding one.
     ///
-    void receiveGarbageDataFromFastModels(SocketIndex index);
+    static PipelineResult sendRecvCoAPMessagesPipelined(const Device& gateway, size_t trials, size_t window);
+
+    ///
+    /// Run the pipelined gateway experiment
+    ///
+    /// @param gateway The gateway device
+    /// @param trials Specify the number of requests
+    /// @param window Specify the maximum number of requests whose reply has not been received
+    /// @note The calling thread is pinned to the processor designated for the gateway device.
+    ///
+    static void runPipelinedGatewayExperiment(const Device& gateway, size_t trials, size_t window);
+
+    /// Processes that decide when each request of an open-loop gateway experiment is sent
+    enum Arrival
+    {
+        /// Requests are evenly spaced at the target rate
+        kConstant,
+
+        /// Gaps between requests are exponentially distributed with the target rate as the mean rate
+        kPoisson,
+    };
+
+    /// Get the string representation of the given arrival process
+    static inline const char* Arrival2String(Arrival arrival)
+    {
+        switch (arrival)
+        {
+            case kConstant:
+                return "constant";
+
+            case kPoisson:
+                return "poisson";
+        }
+
+        return "unknown";
+    }
+
+    /// The result of an open-loop gateway experiment
+    struct LoadResult
+    {
+        /// The latency of each request in nanoseconds from the moment it is scheduled to be sent until its reply is received
+        /// @note Measuring from the intended send time charges the delay of a request that is sent late to the request itself,
+        ///       so a gateway that stalls cannot hide the latency of the requests queued behind the stall.
+        ExecutionTimeMeasurer::Result latencies;
+
+        /// The latency of each request in nanoseconds from the moment it is actually sent until its reply is received
+        ExecutionTimeMeasurer::Result serviceTimes;
+
+        /// The amount of time between the intended send times of the first and the last request
+        std::chrono::nanoseconds scheduled;
+
+        /// The amount of time between the actual send times of the first and the last request
+        std::chrono::nanoseconds sending;
+
+        /// The amount of time from the moment the first request is scheduled until the last reply is received
+        std::chrono::nanoseconds elapsed;
+
+        /// The maximum amount of time by which a request is sent after its intended send time
+        std::chrono::nanoseconds maxLag;
+
+        /// The number of replies received before the reply to an earlier request
+        size_t reordered;
+
+        /// The number of replies that do not carry the tag of an outstanding request and are therefore matched in order
+        size_t untagged;
+    };
+
+    ///
+    /// Send CoAP request messages on a precomputed schedule regardless of when the translated HTTP request messages arrive
+    ///
+    /// @param gateway The gateway device
+    /// @param trials Specify the number of requests
+    /// @param rate Specify the target number of requests per second
+    /// @param arrival Specify the process that spaces requests
+    /// @return The experiment result.
+    /// @note A dedicated thread sends requests at their intended times while the calling thread receives replies,
+    ///       so a slow gateway does not lower the offered load. Replies are matched to requests in the same way as the pipelined experiment.
+    ///
+    static LoadResult sendRecvCoAPMessagesOpenLoop(const Device& gateway, size_t trials, double rate, Arrival arrival);
+
+    ///
+    /// Run the open-loop gateway experiment
+    ///
+    /// @param gateway The gateway device
+    /// @param trials Specify the number of requests
+    /// @param rate Specify the target number of requests per second
+    /// @param arrival Specify the process that spaces requests
+    /// @note The calling thread is pinned to the processor designated for the gateway device.
+    ///
+    static void runOpenLoopGatewayExperiment(const Device& gateway, size_t trials, double rate, Arrival arrival);
+
+    //
+    // MARK: - Main Controller
+    //
 
     /// Run the controller
     int run();
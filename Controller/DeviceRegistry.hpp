@@ -0,0 +1,161 @@
+//
+//  DeviceRegistry.hpp
+//  Controller
+//
+//  Created by FireWolf on 10/15/26.
+//
+
+#ifndef DeviceRegistry_hpp
+#define DeviceRegistry_hpp
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+
+/// The identifier of a device which is also its index in the registry
+using DeviceID = uint32_t;
+
+///
+/// A fixed-capacity table of devices keyed by their identifiers and grouped by their roles
+///
+/// @tparam Device Specify the type of each device which exposes its role as a public member `role`
+/// @tparam RoleCount Specify the number of roles
+/// @tparam Capacity Specify the maximum number of devices
+/// @note Devices can be added at any time but are never removed, so a device pointer remains valid until the registry is destroyed.
+///       Lookups by identifier and iterations by role never take a lock, so they are safe on the relay path.
+///       Additions are serialized by a lock and published with release semantics.
+///
+template <typename Device, size_t RoleCount, size_t Capacity = 1024>
+struct DeviceRegistry
+{
+private:
+    /// Devices indexed by their identifiers
+    std::unique_ptr<Device> devices[Capacity];
+
+    /// The number of devices published to readers
+    std::atomic<size_t> count = 0;
+
+    /// Identifiers of devices grouped by their roles
+    DeviceID members[RoleCount][Capacity];
+
+    /// The number of devices published to readers for each role
+    std::atomic<size_t> memberCounts[RoleCount] = {};
+
+    /// The lock that serializes additions
+    std::mutex mutex;
+
+public:
+    ///
+    /// Create a device and add it to the registry
+    ///
+    /// @param args Arguments to forward to the constructor of `Device` after the identifier
+    /// @return A non-null pointer to the new device on success, `nullptr` if the registry is full.
+    ///
+    template <typename... Args>
+    Device* add(Args&&... args)
+    {
+        std::lock_guard<std::mutex> lockGuard(this->mutex);
+
+        size_t identifier = this->count.load(std::memory_order_relaxed);
+
+        if (identifier == Capacity)
+        {
+            return nullptr;
+        }
+
+        auto device = std::make_unique<Device>(static_cast<DeviceID>(identifier), std::forward<Args>(args)...);
+
+        auto role = static_cast<size_t>(device->role);
+
+        size_t member = this->memberCounts[role].load(std::memory_order_relaxed);
+
+        this->devices[identifier] = std::move(device);
+
+        this->members[role][member] = static_cast<DeviceID>(identifier);
+
+        this->count.store(identifier + 1, std::memory_order_release);
+
+        this->memberCounts[role].store(member + 1, std::memory_order_release);
+
+        return this->devices[identifier].get();
+    }
+
+    ///
+    /// Get the device with the given identifier
+    ///
+    /// @param identifier The device identifier
+    /// @return A non-null pointer to the device on success, `nullptr` if no such device exists.
+    ///
+    [[nodiscard]]
+    Device* get(DeviceID identifier) const
+    {
+        if (identifier >= this->count.load(std::memory_order_acquire))
+        {
+            return nullptr;
+        }
+
+        return this->devices[identifier].get();
+    }
+
+    ///
+    /// Get the number of devices
+    ///
+    /// @return The device count.
+    ///
+    [[nodiscard]]
+    size_t getCount() const
+    {
+        return this->count.load(std::memory_order_acquire);
+    }
+
+    ///
+    /// Get the number of devices of the given role
+    ///
+    /// @param role The role of devices
+    /// @return The device count.
+    ///
+    template <typename Role>
+    [[nodiscard]]
+    size_t getCount(Role role) const
+    {
+        return this->memberCounts[static_cast<size_t>(role)].load(std::memory_order_acquire);
+    }
+
+    ///
+    /// Invoke the given handler on every device
+    ///
+    /// @param handler A callable object invoked as `handler(device)` for each device in the order of identifiers
+    ///
+    template <typename Handler>
+    void forEach(Handler&& handler) const
+    {
+        size_t total = this->getCount();
+
+        for (size_t identifier = 0; identifier < total; identifier += 1)
+        {
+            handler(*this->devices[identifier]);
+        }
+    }
+
+    ///
+    /// Invoke the given handler on every device of the given role
+    ///
+    /// @param role The role of devices
+    /// @param handler A callable object invoked as `handler(device)` for each device in the order of identifiers
+    ///
+    template <typename Role, typename Handler>
+    void forEach(Role role, Handler&& handler) const
+    {
+        auto index = static_cast<size_t>(role);
+
+        size_t total = this->memberCounts[index].load(std::memory_order_acquire);
+
+        for (size_t member = 0; member < total; member += 1)
+        {
+            handler(*this->devices[this->members[index][member]]);
+        }
+    }
+};
+
+#endif /* DeviceRegistry_hpp */
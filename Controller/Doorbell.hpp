@@ -0,0 +1,109 @@
+//
+//  Doorbell.hpp
+//  Controller
+//
+//  Created by FireWolf on 10/15/26.
+//
+
+#ifndef Doorbell_hpp
+#define Doorbell_hpp
+
+#include "StreamSocket.hpp"
+#include "Debug.hpp"
+
+#if __has_include(<sys/eventfd.h>)
+    #include <sys/eventfd.h>
+    #define DOORBELL_AVAILABLE 1
+#else
+    #define DOORBELL_AVAILABLE 0
+#endif
+
+#if DOORBELL_AVAILABLE
+
+///
+/// A descriptor that becomes readable when another thread rings it
+///
+/// @note Threads that multiplex descriptors with epoll or io_uring watch the doorbell along with their other descriptors,
+///       so other threads can wake them up without a signal or a timeout.
+///
+struct Doorbell
+{
+private:
+    /// The event descriptor managed by this class
+    int descriptor;
+
+    //
+    // MARK: - Constructor & Destructor
+    //
+
+public:
+    ///
+    /// Create a doorbell that has not been rung
+    ///
+    /// @throws SocketException if failed to create the event descriptor.
+    ///
+    Doorbell()
+    {
+        this->descriptor = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+
+        if (this->descriptor < 0)
+        {
+            throw SocketException("Failed to create the event descriptor. Reason: {}.", strerror(errno));
+        }
+    }
+
+    /// The copy constructor is not available
+    Doorbell(const Doorbell& other) = delete;
+
+    /// Release the doorbell
+    ~Doorbell()
+    {
+        close(this->descriptor);
+    }
+
+    /// Copy assignment is not available
+    Doorbell& operator=(const Doorbell& other) = delete;
+
+    //
+    // MARK: - Ring the Doorbell
+    //
+
+    ///
+    /// Get the event descriptor managed by this class
+    ///
+    /// @return The descriptor which is readable once the doorbell has been rung.
+    ///
+    [[nodiscard]]
+    int getDescriptor() const
+    {
+        return this->descriptor;
+    }
+
+    ///
+    /// Ring the doorbell
+    ///
+    /// @note Rings that happen before the doorbell is cleared are merged into one.
+    ///
+    void ring() const
+    {
+        uint64_t value = 1;
+
+        psoftassert(write(this->descriptor, &value, sizeof(value)) == sizeof(value), "Failed to ring the doorbell. Reason: %s.", errorstr);
+    }
+
+    ///
+    /// Clear the doorbell so that the descriptor is no longer readable
+    ///
+    /// @return `true` if the doorbell has been rung since it was last cleared, `false` otherwise.
+    ///
+    bool clear() const
+    {
+        uint64_t value = 0;
+
+        return read(this->descriptor, &value, sizeof(value)) == sizeof(value);
+    }
+};
+
+#endif /* DOORBELL_AVAILABLE */
+
+#endif /* Doorbell_hpp */
@@ -0,0 +1,348 @@
+//
+//  Endpoint.hpp
+//  Controller
+//
+//  Created by FireWolf on 10/15/26.
+//
+
+#ifndef Endpoint_hpp
+#define Endpoint_hpp
+
+#include "StreamSocket.hpp"
+#include "ListeningSocket.hpp"
+#include "MPSCRingQueue.hpp"
+#include <string>
+#include <optional>
+#include <chrono>
+
+/// Describes where the controller finds the serial port of an emulated device
+struct Endpoint
+{
+private:
+    ///
+    /// Parse the address of an endpoint
+    ///
+    /// @param string A port number, a path prefixed by `unix:` or a path prefixed by `tty:`
+    /// @return The endpoint on success, `std::nullopt` if the given string is malformed.
+    ///
+    static std::optional<Endpoint> parseAddress(const std::string& string)
+    {
+        static const std::string kUnixPrefix = "unix:";
+
+        static const std::string kTerminalPrefix = "tty:";
+
+        if (string.starts_with(kUnixPrefix))
+        {
+            if (string.size() == kUnixPrefix.size())
+            {
+                return std::nullopt;
+            }
+
+            return Endpoint{ .kind = kUnix, .port = 0, .path = string.substr(kUnixPrefix.size()) };
+        }
+
+        if (string.starts_with(kTerminalPrefix))
+        {
+            if (string.size() == kTerminalPrefix.size())
+            {
+                return std::nullopt;
+            }
+
+            return Endpoint{ .kind = kTerminal, .port = 0, .path = string.substr(kTerminalPrefix.size()) };
+        }
+
+        char* end = nullptr;
+
+        unsigned long port = strtoul(string.c_str(), &end, 10);
+
+        if (string.empty() || *end != '\0' || port == 0 || port > UINT16_MAX)
+        {
+            return std::nullopt;
+        }
+
+        return Endpoint{ .kind = kTCP, .port = static_cast<in_port_t>(port), .path = {} };
+    }
+
+    ///
+    /// Parse a parameter that follows the address of an endpoint
+    ///
+    /// @param parameter One of `spin`, `coalesce`, `cpu=<index>`, `timeout=<milliseconds>`, `offline=<buffer|drop>`,
+    ///                  `queue=<block|drop-oldest|drop-newest|coalesce>`, `capacity=<count>`, `high=<count>`, `low=<count>`,
+    ///                  `vmin=<1-255>` and `vtime=<0-255>`
+    /// @return `true` if the parameter is valid and applied to this endpoint, `false` otherwise.
+    /// @note `vmin` and `vtime` are only valid if the endpoint is `kTerminal`.
+    ///       `vmin` must not be 0, since a read would then return no data once the line is idle, which is indistinguishable from a hangup.
+    ///
+    bool parseParameter(const std::string& parameter)
+    {
+        if (parameter == "spin")
+        {
+            this->spin = true;
+
+            return true;
+        }
+
+        if (parameter == "coalesce")
+        {
+            this->queue.coalesce = true;
+
+            return true;
+        }
+
+        size_t separator = parameter.find('=');
+
+        if (separator == std::string::npos || separator + 1 == parameter.size())
+        {
+            return false;
+        }
+
+        std::string key = parameter.substr(0, separator);
+
+        if (key == "offline")
+        {
+            std::string policy = parameter.substr(separator + 1);
+
+            this->dropOffline = policy == "drop";
+
+            return policy == "drop" || policy == "buffer";
+        }
+
+        if (key == "queue")
+        {
+            auto policy = QueueOptions::parsePolicy(parameter.substr(separator + 1));
+
+            this->queue.policy = policy.value_or(this->queue.policy);
+
+            return policy.has_value();
+        }
+
+        char* last = nullptr;
+
+        unsigned long value = strtoul(parameter.c_str() + separator + 1, &last, 10);
+
+        if (*last != '\0')
+        {
+            return false;
+        }
+
+        if (key == "cpu" && value <= UINT32_MAX)
+        {
+            this->cpu = static_cast<uint32_t>(value);
+
+            return true;
+        }
+
+        if (key == "timeout" && value > 0 && value <= UINT32_MAX)
+        {
+            this->timeout = std::chrono::milliseconds(value);
+
+            return true;
+        }
+
+        if (key == "capacity" && value > 0 && value <= UINT32_MAX)
+        {
+            this->queue.capacity = value;
+
+            return true;
+        }
+
+        if (key == "high" && value > 0 && value <= UINT32_MAX)
+        {
+            this->queue.highWatermark = value;
+
+            return true;
+        }
+
+        if (key == "low" && value > 0 && value <= UINT32_MAX)
+        {
+            this->queue.lowWatermark = value;
+
+            return true;
+        }
+
+        if (this->kind != kTerminal || value > UINT8_MAX)
+        {
+            return false;
+        }
+
+        if (key == "vmin" && value > 0)
+        {
+            this->vmin = static_cast<cc_t>(value);
+
+            return true;
+        }
+
+        if (key == "vtime")
+        {
+            this->vtime = static_cast<cc_t>(value);
+
+            return true;
+        }
+
+        return false;
+    }
+
+public:
+    /// Kinds of endpoints
+    enum Kind
+    {
+        /// A TCP port on the loopback interface (e.g. `-serial tcp::10000,server`)
+        kTCP,
+
+        /// A Unix domain socket (e.g. `-serial unix:/tmp/monitor.sock,server`)
+        kUnix,
+
+        /// A terminal device such as a pseudo terminal (e.g. `-serial pty`) or a UART
+        kTerminal,
+    };
+
+    /// The kind of the endpoint
+    Kind kind;
+
+    /// The TCP port number if the endpoint is `kTCP`
+    in_port_t port;
+
+    /// The path of the socket if the endpoint is `kUnix` or the terminal device if the endpoint is `kTerminal`
+    std::string path;
+
+    /// The minimum number of bytes returned by a read if the endpoint is `kTerminal` (one message by default)
+    cc_t vmin = 8;
+
+    /// The inter-byte timeout in tenths of a second if the endpoint is `kTerminal`
+    cc_t vtime = 1;
+
+    /// `true` if the thread that receives from the endpoint should spin on a non-blocking descriptor
+    bool spin = false;
+
+    /// The index of the processor to which the thread that receives from the endpoint is pinned
+    std::optional<uint32_t> cpu = std::nullopt;
+
+    /// The maximum amount of time to connect to the endpoint and receive the preamble from the device
+    std::chrono::milliseconds timeout = std::chrono::milliseconds(5000);
+
+    /// `true` if commands sent to the device while it is disconnected are dropped,
+    /// `false` if they are delivered once the device is reconnected
+    bool dropOffline = false;
+
+    /// The bound of the queue of commands sent to the device and what producers do once it is full
+    QueueOptions queue = {};
+
+    ///
+    /// Parse an endpoint specified on the command line
+    ///
+    /// @param string A port number such as `10000`,
+    ///               a path prefixed by `unix:` such as `unix:/tmp/monitor.sock`,
+    ///               or a path prefixed by `tty:` such as `tty:/dev/pts/3,vmin=8,vtime=1`,
+    ///               followed by zero or more parameters such as `10000,spin,cpu=2`
+    /// @return The endpoint on success, `std::nullopt` if the given string is malformed.
+    ///
+    static std::optional<Endpoint> parse(const std::string& string)
+    {
+        size_t start = string.find(',');
+
+        auto endpoint = parseAddress(string.substr(0, start));
+
+        if (!endpoint)
+        {
+            return std::nullopt;
+        }
+
+        while (start != std::string::npos)
+        {
+            size_t end = string.find(',', start + 1);
+
+            if (!endpoint->parseParameter(string.substr(start + 1, end == std::string::npos ? std::string::npos : end - start - 1)))
+            {
+                return std::nullopt;
+            }
+
+            start = end;
+        }
+
+        return endpoint;
+    }
+
+    ///
+    /// Get a human-readable description of the endpoint
+    ///
+    /// @return The description.
+    ///
+    [[nodiscard]]
+    std::string description() const
+    {
+        switch (this->kind)
+        {
+            case kTCP:
+                return SocketAddressPrinter{}(std::make_pair(INADDR_LOOPBACK, this->port));
+
+            case kUnix:
+                return SocketAddressPrinter{}(SocketAddressUnix{ this->path });
+
+            case kTerminal:
+                return SocketAddressPrinter{}(SerialPortAddress{ this->path, this->vmin, this->vtime });
+        }
+
+        __builtin_unreachable();
+    }
+
+    ///
+    /// Connect to the endpoint
+    ///
+    /// @param blocking Pass `false` to return a non-blocking socket as soon as the connection is initiated
+    /// @return A stream socket connected to the endpoint.
+    /// @throws SocketException if failed to connect to the endpoint.
+    ///
+    [[nodiscard]]
+    StreamSocket connect(bool blocking = true) const
+    {
+        switch (this->kind)
+        {
+            case kTCP:
+                return { std::make_pair(INADDR_LOOPBACK, 0), std::make_pair(INADDR_LOOPBACK, this->port), blocking };
+
+            case kUnix:
+                return StreamSocket(SocketAddressUnix{ this->path }, blocking);
+
+            case kTerminal:
+            {
+                StreamSocket socket(SerialPortAddress{ this->path, this->vmin, this->vtime });
+
+                if (!blocking && !socket.setBlocking(false))
+                {
+                    throw SocketException("Failed to put {} into non-blocking mode. Reason: {}.", this->description(), strerror(errno));
+                }
+
+                return socket;
+            }
+        }
+
+        __builtin_unreachable();
+    }
+
+    ///
+    /// Listen for connections from devices on the endpoint
+    ///
+    /// @return A socket that accepts connections on the endpoint.
+    /// @throws SocketException if failed to listen on the endpoint;
+    ///                         if the endpoint is `kTerminal`, because a terminal device cannot accept connections.
+    ///
+    [[nodiscard]]
+    ListeningSocket listen() const
+    {
+        switch (this->kind)
+        {
+            case kTCP:
+                return ListeningSocket(std::make_pair(INADDR_LOOPBACK, this->port));
+
+            case kUnix:
+                return ListeningSocket(SocketAddressUnix{ this->path });
+
+            case kTerminal:
+                throw SocketException("Cannot listen on the terminal device {}.", this->path);
+        }
+
+        __builtin_unreachable();
+    }
+};
+
+#endif /* Endpoint_hpp */
@@ -76,6 +76,20 @@ struct ExecutionTimeMeasurer
 
             return tmp[this->durations.size() / 2];
         }
+
+        /// Get the execution time below which the given fraction of trials fall
+        [[nodiscard]] uint64_t percentile(double fraction) const
+        {
+            auto tmp = this->durations;
+
+            auto rank = static_cast<size_t>(fraction * static_cast<double>(tmp.size()));
+
+            auto nth = tmp.begin() + static_cast<ptrdiff_t>(std::min(rank, tmp.size() - 1));
+
+            std::nth_element(tmp.begin(), nth, tmp.end());
+
+            return *nth;
+        }
     };
 
     ///
@@ -0,0 +1,142 @@
+//
+//  FrameReader.hpp
+//  Controller
+//
+//  Created by FireWolf on 10/15/26.
+//
+
+#ifndef FrameReader_hpp
+#define FrameReader_hpp
+
+#include "StreamSocket.hpp"
+#include <cstring>
+#include <algorithm>
+#include <type_traits>
+#include <array>
+#include <bit>
+
+///
+/// A per-connection receive buffer that splits a byte stream into fixed-size frames
+///
+/// @tparam Frame Specify the type of each frame
+/// @tparam Capacity Specify the number of bytes that the buffer can hold
+/// @note The reader pulls as many bytes as available with a single system call,
+///       so a burst of frames is decoded from one read.
+///
+template <typename Frame, size_t Capacity = 4096>
+requires std::is_trivially_copyable_v<Frame> && (Capacity >= sizeof(Frame))
+struct FrameReader
+{
+private:
+    /// The buffer storage
+    uint8_t buffer[Capacity];
+
+    /// The offset of the first byte that has not been consumed
+    size_t head = 0;
+
+    /// The offset past the last byte received
+    size_t tail = 0;
+
+    ///
+    /// Move the bytes that have not been consumed to the beginning of the buffer
+    ///
+    /// @note At most `sizeof(Frame) - 1` bytes are moved after all complete frames are consumed.
+    ///
+    void compact()
+    {
+        if (this->head == 0)
+        {
+            return;
+        }
+
+        memmove(this->buffer, this->buffer + this->head, this->tail - this->head);
+
+        this->tail -= this->head;
+
+        this->head = 0;
+    }
+
+public:
+    //
+    // MARK: - Manage the Buffer
+    //
+
+    ///
+    /// Discard all bytes that have not been consumed
+    ///
+    /// @note The caller should reset the reader once the connection is replaced, since a partial frame cannot be completed.
+    ///
+    void reset()
+    {
+        this->head = 0;
+
+        this->tail = 0;
+    }
+
+    ///
+    /// Receive as many bytes as available from the given socket with a single system call
+    ///
+    /// @param socket A connected socket
+    /// @return `true` on success, `false` if the connection is closed or an error occurred.
+    /// @note The caller remains blocked until at least one byte is received if the socket is in blocking mode.
+    ///
+    bool receive(const StreamSocket& socket)
+    {
+        this->compact();
+
+        size_t length = Capacity - this->tail;
+
+        if (!socket.receive(this->buffer + this->tail, length))
+        {
+            return false;
+        }
+
+        this->tail += length;
+
+        return true;
+    }
+
+    ///
+    /// Append the given data to the buffer
+    ///
+    /// @param data The data received from elsewhere
+    /// @param length The number of bytes available
+    /// @return The number of bytes appended which may be less than `length` if the buffer is full.
+    /// @note The caller should consume all complete frames and append the remaining data again.
+    ///
+    size_t append(const void* data, size_t length)
+    {
+        this->compact();
+
+        size_t count = std::min(length, Capacity - this->tail);
+
+        memcpy(this->buffer + this->tail, data, count);
+
+        this->tail += count;
+
+        return count;
+    }
+
+    ///
+    /// Remove the next complete frame from the buffer
+    ///
+    /// @return The frame on success, `std::nullopt` if no complete frame is available.
+    ///
+    std::optional<Frame> next()
+    {
+        if (this->tail - this->head < sizeof(Frame))
+        {
+            return std::nullopt;
+        }
+
+        std::array<uint8_t, sizeof(Frame)> bytes;
+
+        memcpy(bytes.data(), this->buffer + this->head, sizeof(Frame));
+
+        this->head += sizeof(Frame);
+
+        return std::bit_cast<Frame>(bytes);
+    }
+};
+
+#endif /* FrameReader_hpp */
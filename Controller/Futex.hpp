@@ -0,0 +1,116 @@
+//
+//  Futex.hpp
+//  Controller
+//
+//  Created by FireWolf on 10/15/26.
+//
+
+#ifndef Futex_hpp
+#define Futex_hpp
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#if defined(__linux__)
+    #include <linux/futex.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+    #include <ctime>
+#else
+    #include <mutex>
+    #include <condition_variable>
+#endif
+
+///
+/// A 32-bit word on which threads can sleep until another thread changes it
+///
+/// @note On Linux, waiters sleep in the kernel via the futex system call.
+///       On other platforms, a mutex and a condition variable emulate the same semantics.
+///
+struct Futex
+{
+private:
+    /// The word shared by waiters and wakers
+    std::atomic<uint32_t> word = 0;
+
+#if !defined(__linux__)
+    /// The mutex that orders waiters and wakers
+    std::mutex mutex;
+
+    /// The condition variable on which waiters sleep
+    std::condition_variable changed;
+#endif
+
+public:
+    ///
+    /// Load the current value of the word
+    ///
+    /// @return The current value.
+    ///
+    [[nodiscard]]
+    uint32_t load() const
+    {
+        return this->word.load(std::memory_order_acquire);
+    }
+
+    ///
+    /// Sleep until the word no longer holds the expected value or the timeout expires
+    ///
+    /// @param expected The value that the caller observed before deciding to sleep
+    /// @param timeout The maximum amount of time to sleep, or a negative value to sleep indefinitely
+    /// @note The caller may wake up spuriously and must check its condition again.
+    ///
+    void wait(uint32_t expected, std::chrono::nanoseconds timeout = std::chrono::nanoseconds(-1))
+    {
+    #if defined(__linux__)
+        timespec duration = {};
+
+        timespec* pointer = nullptr;
+
+        if (timeout.count() >= 0)
+        {
+            duration.tv_sec = static_cast<time_t>(timeout.count() / 1'000'000'000);
+
+            duration.tv_nsec = static_cast<long>(timeout.count() % 1'000'000'000);
+
+            pointer = &duration;
+        }
+
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&this->word), FUTEX_WAIT_PRIVATE, expected, pointer, nullptr, 0);
+    #else
+        std::unique_lock<std::mutex> lock(this->mutex);
+
+        auto predicate = [&]() -> bool { return this->word.load(std::memory_order_acquire) != expected; };
+
+        if (timeout.count() >= 0)
+        {
+            this->changed.wait_for(lock, timeout, predicate);
+        }
+        else
+        {
+            this->changed.wait(lock, predicate);
+        }
+    #endif
+    }
+
+    ///
+    /// Change the word and wake up all waiters
+    ///
+    void signal()
+    {
+        this->word.fetch_add(1, std::memory_order_release);
+
+    #if defined(__linux__)
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&this->word), FUTEX_WAKE_PRIVATE, INT32_MAX, nullptr, nullptr, 0);
+    #else
+        {
+            std::lock_guard<std::mutex> lockGuard(this->mutex);
+        }
+
+        this->changed.notify_all();
+    #endif
+    }
+};
+
+#endif /* Futex_hpp */
@@ -0,0 +1,476 @@
+//
+//  HTTPRequestReader.hpp
+//  Controller
+//
+//  Created by FireWolf on 10/16/26.
+//
+
+#ifndef HTTPRequestReader_hpp
+#define HTTPRequestReader_hpp
+
+#include "StreamSocket.hpp"
+#include <string_view>
+#include <optional>
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+
+/// Reasons for which a byte stream does not carry a well-formed HTTP/1.1 request
+enum HTTPParseError
+{
+    /// The request line does not consist of a method, a target and an HTTP version
+    kMalformedRequestLine,
+
+    /// A header line does not have a name followed by a colon
+    kMalformedHeader,
+
+    /// The `Content-Length` header is not a decimal number or appears more than once with different values
+    kInvalidContentLength,
+
+    /// The request uses a transfer coding other than identity, which the reader does not decode
+    kUnsupportedTransferEncoding,
+
+    /// The request does not fit in the receive buffer
+    kRequestTooLarge,
+};
+
+/// Get the string representation of the given parse error
+static inline const char* HTTPParseError2String(HTTPParseError error)
+{
+    switch (error)
+    {
+        case kMalformedRequestLine:
+            return "Malformed request line";
+
+        case kMalformedHeader:
+            return "Malformed header";
+
+        case kInvalidContentLength:
+            return "Invalid Content-Length";
+
+        case kUnsupportedTransferEncoding:
+            return "Unsupported Transfer-Encoding";
+
+        case kRequestTooLarge:
+            return "Request too large";
+    }
+
+    return "Unknown";
+}
+
+///
+/// A view of an HTTP request in a receive buffer
+///
+/// @note All fields refer to the buffer of the reader that produces the view.
+///
+struct HTTPRequestView
+{
+    /// The method, such as `POST`
+    std::string_view method;
+
+    /// The request target, such as `/moisture`
+    std::string_view path;
+
+    /// The protocol version, such as `HTTP/1.1`
+    std::string_view version;
+
+    /// The value of the `Host` header, which is empty if the request does not have one
+    std::string_view host;
+
+    /// The header lines, each of which ends with CRLF
+    std::string_view headers;
+
+    /// The message body
+    std::string_view body;
+
+    /// The whole request from the request line to the end of the body
+    std::string_view message;
+
+    ///
+    /// Find the first header that has the given name
+    ///
+    /// @param name The header name which is matched case-insensitively
+    /// @return The header value without surrounding whitespaces on success, `std::nullopt` if the request does not have the header.
+    ///
+    [[nodiscard]]
+    std::optional<std::string_view> findHeader(std::string_view name) const
+    {
+        std::optional<std::string_view> result;
+
+        forEachHeader(this->headers, [&](std::string_view key, std::string_view value) -> bool
+        {
+            if (!equalsIgnoringCase(key, name))
+            {
+                return true;
+            }
+
+            result = value;
+
+            return false;
+        });
+
+        return result;
+    }
+
+    ///
+    /// Compare two strings case-insensitively
+    ///
+    /// @param lhs A string
+    /// @param rhs A string that contains only ASCII characters
+    /// @return `true` if the strings are equal regardless of the case of letters, `false` otherwise.
+    ///
+    static bool equalsIgnoringCase(std::string_view lhs, std::string_view rhs)
+    {
+        auto lowercase = [](char character) -> char
+        {
+            return character >= 'A' && character <= 'Z' ? static_cast<char>(character | 0x20) : character;
+        };
+
+        return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), [&](char x, char y) -> bool
+        {
+            return lowercase(x) == lowercase(y);
+        });
+    }
+
+    ///
+    /// Visit the header lines
+    ///
+    /// @param headers The header lines, each of which ends with CRLF
+    /// @param visitor A callable object that takes the name and the value of each header and returns `false` to stop the visit
+    /// @return `true` if all lines are well-formed headers, `false` otherwise.
+    ///
+    template <typename Visitor>
+    static bool forEachHeader(std::string_view headers, Visitor&& visitor)
+    {
+        static constexpr std::string_view kWhitespaces = " \t";
+
+        while (!headers.empty())
+        {
+            size_t end = headers.find("\r\n");
+
+            std::string_view line = headers.substr(0, end);
+
+            headers.remove_prefix(std::min(headers.size(), end + 2));
+
+            size_t colon = line.find(':');
+
+            // Guard: The name must not be empty or end with whitespaces
+            if (colon == 0 || colon == std::string_view::npos || kWhitespaces.find(line[colon - 1]) != std::string_view::npos)
+            {
+                return false;
+            }
+
+            std::string_view value = line.substr(colon + 1);
+
+            value.remove_prefix(std::min(value.size(), value.find_first_not_of(kWhitespaces)));
+
+            value.remove_suffix(value.size() - std::min(value.size(), value.find_last_not_of(kWhitespaces) + 1));
+
+            if (!visitor(line.substr(0, colon), value))
+            {
+                break;
+            }
+        }
+
+        return true;
+    }
+};
+
+///
+/// A per-connection receive buffer that splits a byte stream into HTTP/1.1 requests without copying them
+///
+/// @tparam Capacity Specify the number of bytes that the buffer can hold, which bounds the size of a request
+/// @note The reader pulls as many bytes as available with a single system call, so a burst of pipelined requests is parsed from one read.
+///       The end of the header section is searched incrementally, so bytes are not scanned again when a request arrives in pieces.
+///       A request ends after the number of bytes given by its `Content-Length` header,
+///       or after the default body length if the header is absent, since the gateway appends the CoAP payload without declaring its length.
+///
+template <size_t Capacity = 4096>
+struct HTTPRequestReader
+{
+private:
+    /// The buffer storage
+    char buffer[Capacity];
+
+    /// The offset of the first byte that has not been consumed
+    size_t head = 0;
+
+    /// The offset past the last byte received
+    size_t tail = 0;
+
+    /// The offset at which the search for the end of the header section resumes
+    size_t scanned = 0;
+
+    /// The number of bytes in the body of a request that does not have the `Content-Length` header
+    size_t defaultBodyLength;
+
+    /// The reason for which the stream is malformed, or `std::nullopt` if it is well-formed so far
+    std::optional<HTTPParseError> error;
+
+    ///
+    /// Move the bytes that have not been consumed to the beginning of the buffer
+    ///
+    void compact()
+    {
+        if (this->head == 0)
+        {
+            return;
+        }
+
+        memmove(this->buffer, this->buffer + this->head, this->tail - this->head);
+
+        this->tail -= this->head;
+
+        this->scanned -= this->head;
+
+        this->head = 0;
+    }
+
+    ///
+    /// Record the reason for which the stream is malformed
+    ///
+    /// @param reason The reason
+    /// @return `std::nullopt`.
+    ///
+    std::optional<HTTPRequestView> fail(HTTPParseError reason)
+    {
+        this->error = reason;
+
+        return std::nullopt;
+    }
+
+    //
+    // MARK: - Constructor & Destructor
+    //
+
+public:
+    ///
+    /// Create an empty reader
+    ///
+    /// @param defaultBodyLength The number of bytes in the body of a request that does not have the `Content-Length` header
+    ///
+    explicit HTTPRequestReader(size_t defaultBodyLength = 0) : defaultBodyLength(defaultBodyLength) {}
+
+    //
+    // MARK: - Manage the Buffer
+    //
+
+    ///
+    /// Discard all bytes that have not been consumed along with the parse error
+    ///
+    void reset()
+    {
+        this->head = 0;
+
+        this->tail = 0;
+
+        this->scanned = 0;
+
+        this->error.reset();
+    }
+
+    ///
+    /// Get the reason for which the stream is malformed
+    ///
+    /// @return The parse error, or `std::nullopt` if the stream is well-formed so far.
+    /// @note The reader stops producing requests once the stream is malformed until it is reset.
+    ///
+    [[nodiscard]]
+    std::optional<HTTPParseError> getError() const
+    {
+        return this->error;
+    }
+
+    ///
+    /// Receive as many bytes as available from the given socket with a single system call
+    ///
+    /// @param socket A connected socket
+    /// @return `true` on success, `false` if the connection is closed, an error occurred or the buffer is full of an incomplete request.
+    /// @note The caller remains blocked until at least one byte is received if the socket is in blocking mode.
+    ///       Views returned by `next()` are invalidated.
+    ///
+    bool receive(const StreamSocket& socket)
+    {
+        this->compact();
+
+        if (this->tail == Capacity)
+        {
+            this->error = kRequestTooLarge;
+
+            return false;
+        }
+
+        size_t length = Capacity - this->tail;
+
+        if (!socket.receive(this->buffer + this->tail, length))
+        {
+            return false;
+        }
+
+        this->tail += length;
+
+        return true;
+    }
+
+    ///
+    /// Append the given data to the buffer
+    ///
+    /// @param data The data received from elsewhere
+    /// @param length The number of bytes available
+    /// @return The number of bytes appended which may be less than `length` if the buffer is full.
+    /// @note Views returned by `next()` are invalidated.
+    ///
+    size_t append(const void* data, size_t length)
+    {
+        this->compact();
+
+        size_t count = std::min(length, Capacity - this->tail);
+
+        memcpy(this->buffer + this->tail, data, count);
+
+        this->tail += count;
+
+        return count;
+    }
+
+    ///
+    /// Remove the next complete request from the buffer
+    ///
+    /// @return A view of the request on success, `std::nullopt` if no complete request is available or the stream is malformed.
+    /// @note The view remains valid until the next call to `receive()`, `append()` or `reset()`.
+    ///       Check `getError()` to tell a malformed stream from an incomplete request.
+    ///
+    std::optional<HTTPRequestView> next()
+    {
+        static constexpr std::string_view kTerminator = "\r\n\r\n";
+
+        if (this->error)
+        {
+            return std::nullopt;
+        }
+
+        std::string_view available(this->buffer + this->head, this->tail - this->head);
+
+        // Resume the search a few bytes before the last scanned position in case the terminator straddles two receives
+        size_t from = this->scanned - this->head;
+
+        from -= std::min(from, kTerminator.size() - 1);
+
+        size_t terminator = available.find(kTerminator, from);
+
+        if (terminator == std::string_view::npos)
+        {
+            this->scanned = this->tail;
+
+            if (this->head == 0 && this->tail == Capacity)
+            {
+                return this->fail(kRequestTooLarge);
+            }
+
+            return std::nullopt;
+        }
+
+        HTTPRequestView request = {};
+
+        // The request line: `<METHOD> <TARGET> <VERSION>`
+        std::string_view header = available.substr(0, terminator + 2);
+
+        size_t lineEnd = header.find("\r\n");
+
+        std::string_view line = header.substr(0, lineEnd);
+
+        size_t first = line.find(' '), last = line.rfind(' ');
+
+        if (first == std::string_view::npos || first == 0 || last == first || last + 1 == line.size() || line.substr(first + 1, last - first - 1).find(' ') != std::string_view::npos)
+        {
+            return this->fail(kMalformedRequestLine);
+        }
+
+        request.method = line.substr(0, first);
+
+        request.path = line.substr(first + 1, last - first - 1);
+
+        request.version = line.substr(last + 1);
+
+        if (!request.version.starts_with("HTTP/"))
+        {
+            return this->fail(kMalformedRequestLine);
+        }
+
+        request.headers = header.substr(lineEnd + 2);
+
+        // The headers that decide the length of the body
+        std::optional<size_t> contentLength;
+
+        bool valid = true, chunked = false;
+
+        bool wellFormed = HTTPRequestView::forEachHeader(request.headers, [&](std::string_view name, std::string_view value) -> bool
+        {
+            if (HTTPRequestView::equalsIgnoringCase(name, "Host"))
+            {
+                request.host = request.host.empty() ? value : request.host;
+            }
+            else if (HTTPRequestView::equalsIgnoringCase(name, "Content-Length"))
+            {
+                size_t length = 0;
+
+                auto [end, status] = std::from_chars(value.data(), value.data() + value.size(), length);
+
+                valid = valid && !value.empty() && status == std::errc() && end == value.data() + value.size() && (!contentLength || *contentLength == length);
+
+                contentLength = length;
+            }
+            else if (HTTPRequestView::equalsIgnoringCase(name, "Transfer-Encoding"))
+            {
+                chunked = chunked || !HTTPRequestView::equalsIgnoringCase(value, "identity");
+            }
+
+            return true;
+        });
+
+        if (!wellFormed)
+        {
+            return this->fail(kMalformedHeader);
+        }
+
+        if (!valid)
+        {
+            return this->fail(kInvalidContentLength);
+        }
+
+        if (chunked)
+        {
+            return this->fail(kUnsupportedTransferEncoding);
+        }
+
+        // Guard: The body must be complete
+        size_t bodyOffset = terminator + kTerminator.size();
+
+        size_t bodyLength = contentLength.value_or(this->defaultBodyLength);
+
+        if (bodyLength > Capacity - bodyOffset)
+        {
+            return this->fail(kRequestTooLarge);
+        }
+
+        if (available.size() - bodyOffset < bodyLength)
+        {
+            // The header section is complete, so the search resumes at its end once the body arrives
+            this->scanned = this->head + terminator;
+
+            return std::nullopt;
+        }
+
+        request.body = available.substr(bodyOffset, bodyLength);
+
+        request.message = available.substr(0, bodyOffset + bodyLength);
+
+        this->head += request.message.size();
+
+        this->scanned = this->head;
+
+        return request;
+    }
+};
+
+#endif /* HTTPRequestReader_hpp */
@@ -0,0 +1,567 @@
+//
+//  IOURing.hpp
+//  Controller
+//
+//  Created by FireWolf on 10/15/26.
+//
+
+#ifndef IOURing_hpp
+#define IOURing_hpp
+
+#include "StreamSocket.hpp"
+
+#if __has_include(<linux/io_uring.h>)
+    #include <linux/io_uring.h>
+    // Multishot receives require Linux 6.0
+    #if defined(IORING_RECV_MULTISHOT)
+        #define IOURING_AVAILABLE 1
+    #else
+        #define IOURING_AVAILABLE 0
+    #endif
+#else
+    #define IOURING_AVAILABLE 0
+#endif
+
+#if IOURING_AVAILABLE
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <poll.h>
+#include <atomic>
+#include <functional>
+#include <memory>
+
+///
+/// A minimal io_uring instance that talks to the kernel via raw system calls
+///
+/// @note Only operations used by the controller are supported:
+///       batched sends, receives into provided buffers and readiness polls.
+///
+struct IOURing
+{
+private:
+    /// The io_uring descriptor managed by this class
+    int descriptor;
+
+    /// Parameters returned by the kernel
+    io_uring_params params;
+
+    /// The memory that maps the submission queue ring
+    void* sqRing;
+
+    /// The size of the submission queue ring
+    size_t sqRingSize;
+
+    /// The memory that maps the completion queue ring
+    void* cqRing;
+
+    /// The size of the completion queue ring
+    size_t cqRingSize;
+
+    /// The memory that maps the submission queue entries
+    io_uring_sqe* sqes;
+
+    /// Pointers into the submission queue ring
+    uint32_t *sqHead, *sqTail, *sqMask, *sqArray;
+
+    /// Pointers into the completion queue ring
+    uint32_t *cqHead, *cqTail, *cqMask;
+
+    /// Completion queue entries
+    io_uring_cqe* cqes;
+
+    /// The number of entries prepared but not yet submitted
+    uint32_t pending;
+
+    /// Load a value shared with the kernel
+    static inline uint32_t load(uint32_t* pointer)
+    {
+        return std::atomic_ref<uint32_t>(*pointer).load(std::memory_order_acquire);
+    }
+
+    /// Store a value shared with the kernel
+    static inline void store(uint32_t* pointer, uint32_t value)
+    {
+        std::atomic_ref<uint32_t>(*pointer).store(value, std::memory_order_release);
+    }
+
+    /// Get a pointer at the given offset in a mapped region
+    template <typename Pointer>
+    static inline Pointer* offset(void* base, uint32_t offset)
+    {
+        return reinterpret_cast<Pointer*>(reinterpret_cast<uint8_t*>(base) + offset);
+    }
+
+    //
+    // MARK: - Constructor & Destructor
+    //
+
+public:
+    ///
+    /// Create an io_uring instance
+    ///
+    /// @param entries The number of submission queue entries
+    /// @throws SocketException if the kernel does not support io_uring or failed to map the rings.
+    ///
+    explicit IOURing(uint32_t entries) : params{}, pending(0)
+    {
+        this->descriptor = static_cast<int>(syscall(__NR_io_uring_setup, entries, &this->params));
+
+        if (this->descriptor < 0)
+        {
+            throw SocketException("Failed to create the io_uring instance. Reason: {}.", strerror(errno));
+        }
+
+        this->sqRingSize = this->params.sq_off.array + this->params.sq_entries * sizeof(uint32_t);
+
+        this->cqRingSize = this->params.cq_off.cqes + this->params.cq_entries * sizeof(io_uring_cqe);
+
+        if (this->params.features & IORING_FEAT_SINGLE_MMAP)
+        {
+            this->sqRingSize = this->cqRingSize = std::max(this->sqRingSize, this->cqRingSize);
+        }
+
+        this->sqRing = mmap(nullptr, this->sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->descriptor, IORING_OFF_SQ_RING);
+
+        if (this->sqRing == MAP_FAILED)
+        {
+            close(this->descriptor);
+
+            throw SocketException("Failed to map the submission queue ring. Reason: {}.", strerror(errno));
+        }
+
+        if (this->params.features & IORING_FEAT_SINGLE_MMAP)
+        {
+            this->cqRing = this->sqRing;
+        }
+        else
+        {
+            this->cqRing = mmap(nullptr, this->cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->descriptor, IORING_OFF_CQ_RING);
+
+            if (this->cqRing == MAP_FAILED)
+            {
+                munmap(this->sqRing, this->sqRingSize);
+
+                close(this->descriptor);
+
+                throw SocketException("Failed to map the completion queue ring. Reason: {}.", strerror(errno));
+            }
+        }
+
+        void* sqes = mmap(nullptr, this->params.sq_entries * sizeof(io_uring_sqe), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->descriptor, IORING_OFF_SQES);
+
+        if (sqes == MAP_FAILED)
+        {
+            if (this->cqRing != this->sqRing)
+            {
+                munmap(this->cqRing, this->cqRingSize);
+            }
+
+            munmap(this->sqRing, this->sqRingSize);
+
+            close(this->descriptor);
+
+            throw SocketException("Failed to map the submission queue entries. Reason: {}.", strerror(errno));
+        }
+
+        this->sqes = reinterpret_cast<io_uring_sqe*>(sqes);
+
+        this->sqHead = offset<uint32_t>(this->sqRing, this->params.sq_off.head);
+
+        this->sqTail = offset<uint32_t>(this->sqRing, this->params.sq_off.tail);
+
+        this->sqMask = offset<uint32_t>(this->sqRing, this->params.sq_off.ring_mask);
+
+        this->sqArray = offset<uint32_t>(this->sqRing, this->params.sq_off.array);
+
+        this->cqHead = offset<uint32_t>(this->cqRing, this->params.cq_off.head);
+
+        this->cqTail = offset<uint32_t>(this->cqRing, this->params.cq_off.tail);
+
+        this->cqMask = offset<uint32_t>(this->cqRing, this->params.cq_off.ring_mask);
+
+        this->cqes = offset<io_uring_cqe>(this->cqRing, this->params.cq_off.cqes);
+    }
+
+    /// The copy constructor is not available
+    IOURing(const IOURing& other) = delete;
+
+    /// Copy assignment is not available
+    IOURing& operator=(const IOURing& other) = delete;
+
+    /// Release the io_uring instance
+    ~IOURing()
+    {
+        munmap(this->sqes, this->params.sq_entries * sizeof(io_uring_sqe));
+
+        if (this->cqRing != this->sqRing)
+        {
+            munmap(this->cqRing, this->cqRingSize);
+        }
+
+        munmap(this->sqRing, this->sqRingSize);
+
+        close(this->descriptor);
+    }
+
+    ///
+    /// Check whether the running kernel supports the io_uring features used by the controller
+    ///
+    /// @return `true` if io_uring instances can be created, buffers can be provided,
+    ///         completion queue entries can be skipped on success and multishot receives are available, `false` otherwise.
+    /// @note The probe arms a multishot receive on a socket pair, since the kernel does not report support for multishot receives otherwise.
+    ///
+    static bool isSupported();
+
+    //
+    // MARK: - Submission
+    //
+
+    ///
+    /// Get a zeroed submission queue entry
+    ///
+    /// @return A non-null entry on success, `nullptr` if the submission queue is full.
+    ///
+    io_uring_sqe* getSubmissionQueueEntry()
+    {
+        uint32_t head = load(this->sqHead);
+
+        uint32_t tail = *this->sqTail + this->pending;
+
+        if (tail - head >= this->params.sq_entries)
+        {
+            return nullptr;
+        }
+
+        uint32_t index = tail & *this->sqMask;
+
+        io_uring_sqe* sqe = &this->sqes[index];
+
+        memset(sqe, 0, sizeof(io_uring_sqe));
+
+        this->sqArray[index] = index;
+
+        this->pending += 1;
+
+        return sqe;
+    }
+
+    ///
+    /// Prepare a send operation
+    ///
+    /// @param sqe A submission queue entry
+    /// @param descriptor The socket or terminal descriptor
+    /// @param data The data to send
+    /// @param length The number of bytes to send
+    /// @param userData An opaque value reported in the completion queue entry
+    /// @note The operation is a write at the current position, so it works on both sockets and terminal devices.
+    ///
+    static void prepareSend(io_uring_sqe* sqe, int descriptor, const void* data, size_t length, uint64_t userData)
+    {
+        sqe->opcode = IORING_OP_WRITE;
+
+        sqe->fd = descriptor;
+
+        sqe->off = UINT64_MAX;
+
+        sqe->addr = reinterpret_cast<uint64_t>(data);
+
+        sqe->len = static_cast<uint32_t>(length);
+
+        sqe->user_data = userData;
+    }
+
+    ///
+    /// Prepare a receive operation that picks buffers from a provided buffer group
+    ///
+    /// @param sqe A submission queue entry
+    /// @param descriptor The socket or terminal descriptor
+    /// @param multishot Pass `true` to keep receiving into new buffers until the operation is cancelled or fails;
+    ///                  the operation must not be multishot if the descriptor is not a socket.
+    /// @param group The identifier of the provided buffer group
+    /// @param userData An opaque value reported in each completion queue entry
+    ///
+    static void prepareReceive(io_uring_sqe* sqe, int descriptor, bool multishot, uint16_t group, uint64_t userData)
+    {
+        if (multishot)
+        {
+            sqe->opcode = IORING_OP_RECV;
+
+            sqe->ioprio = IORING_RECV_MULTISHOT;
+        }
+        else
+        {
+            sqe->opcode = IORING_OP_READ;
+
+            sqe->off = UINT64_MAX;
+        }
+
+        sqe->fd = descriptor;
+
+        sqe->flags = IOSQE_BUFFER_SELECT;
+
+        sqe->buf_group = group;
+
+        sqe->user_data = userData;
+    }
+
+    ///
+    /// Prepare an operation that completes once the given descriptor becomes readable
+    ///
+    /// @param sqe A submission queue entry
+    /// @param descriptor A pollable descriptor
+    /// @param userData An opaque value reported in the completion queue entry
+    ///
+    static void prepareWaitReadable(io_uring_sqe* sqe, int descriptor, uint64_t userData)
+    {
+        sqe->opcode = IORING_OP_POLL_ADD;
+
+        sqe->fd = descriptor;
+
+        sqe->poll32_events = POLLIN;
+
+        sqe->user_data = userData;
+    }
+
+    ///
+    /// Submit prepared entries to the kernel and optionally wait for completions
+    ///
+    /// @param waitCount The minimum number of completions to wait for
+    /// @return The number of entries submitted, or -1 on error.
+    ///
+    int submit(uint32_t waitCount = 0)
+    {
+        store(this->sqTail, *this->sqTail + this->pending);
+
+        uint32_t count = this->pending;
+
+        this->pending = 0;
+
+        while (true)
+        {
+            long result = syscall(__NR_io_uring_enter, this->descriptor, count, waitCount, waitCount > 0 ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+
+            if (result >= 0)
+            {
+                return static_cast<int>(result);
+            }
+
+            if (errno != EINTR)
+            {
+                return -1;
+            }
+
+            // The entries have been consumed by the kernel before the wait is interrupted
+            count = 0;
+        }
+    }
+
+    //
+    // MARK: - Completion
+    //
+
+    ///
+    /// Consume all available completion queue entries
+    ///
+    /// @param handler A callable object invoked as `handler(cqe)` for each completion
+    /// @return The number of completion queue entries consumed.
+    ///
+    template <typename Handler>
+    requires std::invocable<Handler, const io_uring_cqe&>
+    uint32_t complete(Handler&& handler)
+    {
+        uint32_t head = *this->cqHead;
+
+        uint32_t tail = load(this->cqTail);
+
+        for (uint32_t index = head; index != tail; index += 1)
+        {
+            std::invoke(handler, this->cqes[index & *this->cqMask]);
+        }
+
+        store(this->cqHead, tail);
+
+        return tail - head;
+    }
+
+    //
+    // MARK: - Provided Buffers
+    //
+
+    /// A group of fixed-size buffers from which the kernel picks the destination of each receive
+    struct BufferGroup
+    {
+    private:
+        /// The io_uring instance that consumes the buffers
+        IOURing& uring;
+
+        /// The identifier of the buffer group
+        uint16_t group;
+
+        /// The number of buffers
+        uint16_t count;
+
+        /// The size of each buffer
+        uint32_t size;
+
+        /// The storage of all buffers
+        std::unique_ptr<uint8_t[]> storage;
+
+        ///
+        /// Prepare an operation that hands the given buffers to the kernel
+        ///
+        /// @param sqe A submission queue entry
+        /// @param identifier The identifier of the first buffer
+        /// @param number The number of consecutive buffers
+        ///
+        void prepareProvide(io_uring_sqe* sqe, uint16_t identifier, uint16_t number) const
+        {
+            sqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+
+            sqe->fd = number;
+
+            sqe->addr = reinterpret_cast<uint64_t>(this->getBuffer(identifier));
+
+            sqe->len = this->size;
+
+            sqe->off = identifier;
+
+            sqe->buf_group = this->group;
+
+            sqe->user_data = kUserData;
+        }
+
+    public:
+        /// The opaque value reported in the completion queue entry of a failed recycle operation
+        static constexpr uint64_t kUserData = UINT64_MAX;
+
+        ///
+        /// Create a buffer group and hand all buffers to the kernel
+        ///
+        /// @param uring The io_uring instance that consumes the buffers
+        /// @param group The identifier of the buffer group
+        /// @param count The number of buffers
+        /// @param size The size of each buffer
+        /// @throws SocketException if failed to provide the buffers.
+        /// @note Legacy provided buffers are used instead of a registered buffer ring,
+        ///       because some kernels accept the ring registration but never pick buffers from it.
+        ///
+        BufferGroup(IOURing& uring, uint16_t group, uint16_t count, uint32_t size)
+            : uring(uring), group(group), count(count), size(size), storage(new uint8_t[static_cast<size_t>(count) * size])
+        {
+            io_uring_sqe* sqe = uring.getSubmissionQueueEntry();
+
+            if (sqe == nullptr)
+            {
+                throw SocketException("Failed to provide the buffers. Reason: The submission queue is full.");
+            }
+
+            this->prepareProvide(sqe, 0, count);
+
+            if (uring.submit(1) < 0)
+            {
+                throw SocketException("Failed to provide the buffers. Reason: {}.", strerror(errno));
+            }
+
+            int result = 0;
+
+            uring.complete([&](const io_uring_cqe& cqe) -> void { result = cqe.res; });
+
+            if (result < 0)
+            {
+                throw SocketException("Failed to provide the buffers. Reason: {}.", strerror(-result));
+            }
+        }
+
+        /// The copy constructor is not available
+        BufferGroup(const BufferGroup& other) = delete;
+
+        /// Copy assignment is not available
+        BufferGroup& operator=(const BufferGroup& other) = delete;
+
+        ///
+        /// Get the buffer with the given identifier
+        ///
+        /// @param identifier The buffer identifier reported in a completion queue entry
+        /// @return A pointer to the buffer.
+        ///
+        [[nodiscard]]
+        const uint8_t* getBuffer(uint16_t identifier) const
+        {
+            return this->storage.get() + static_cast<size_t>(identifier) * this->size;
+        }
+
+        ///
+        /// Return the buffer with the given identifier to the kernel
+        ///
+        /// @param identifier The buffer identifier reported in a completion queue entry
+        /// @note The buffer is handed back on the next submission.
+        ///       A completion queue entry tagged with `kUserData` is posted only if the operation fails.
+        ///
+        void recycle(uint16_t identifier)
+        {
+            io_uring_sqe* sqe = this->uring.getSubmissionQueueEntry();
+
+            // Flush the prepared entries if the submission queue is full
+            if (sqe == nullptr)
+            {
+                this->uring.submit();
+
+                sqe = this->uring.getSubmissionQueueEntry();
+            }
+
+            this->prepareProvide(sqe, identifier, 1);
+
+            sqe->flags = IOSQE_CQE_SKIP_SUCCESS;
+        }
+    };
+};
+
+inline bool IOURing::isSupported()
+{
+    // A pair of connected sockets on which a multishot receive is tried
+    int sockets[2];
+
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0)
+    {
+        return false;
+    }
+
+    bool supported = false;
+
+    try
+    {
+        IOURing uring(4);
+
+        BufferGroup buffers(uring, 0, 1, 64);
+
+        // Guard: Recycled buffers do not post a completion queue entry on success (Linux 5.17)
+        if (uring.params.features & IORING_FEAT_CQE_SKIP)
+        {
+            // Multishot receives (Linux 6.0) fail with `EINVAL` on older kernels, and a supported one remains armed after receiving data
+            prepareReceive(uring.getSubmissionQueueEntry(), sockets[0], true, 0, 0);
+
+            if (write(sockets[1], "", 1) == 1 && uring.submit(1) >= 0)
+            {
+                uring.complete([&](const io_uring_cqe& cqe) -> void
+                {
+                    supported = cqe.res == 1 && (cqe.flags & IORING_CQE_F_MORE) != 0;
+                });
+            }
+        }
+    }
+    catch (SocketException& exception)
+    {
+        supported = false;
+    }
+
+    close(sockets[0]);
+
+    close(sockets[1]);
+
+    return supported;
+}
+
+#endif /* IOURING_AVAILABLE */
+
+#endif /* IOURing_hpp */
@@ -0,0 +1,454 @@
+//
+//  LaneQueue.hpp
+//  Controller
+//
+//  Created by FireWolf on 10/16/26.
+//
+
+#ifndef LaneQueue_hpp
+#define LaneQueue_hpp
+
+#include "MPSCRingQueue.hpp"
+#include <array>
+#include <vector>
+#include <string>
+#include <utility>
+
+/// Options that decide how the consumer of a lane queue picks the next element
+struct LaneOptions
+{
+    /// How the consumer picks the lane of the next element
+    enum Scheduling
+    {
+        /// The consumer always takes the element from the non-empty lane with the highest priority
+        kStrict,
+
+        /// The consumer visits lanes in a round robin and takes up to the weight of each lane before moving on
+        kWeighted,
+    };
+
+    /// How the consumer picks the lane of the next element
+    Scheduling scheduling = kStrict;
+
+    /// The weight of each lane in the order of priority under the `kWeighted` scheduling
+    /// @note Lanes without a weight have the default one, which halves from one lane to the next and ends with 1.
+    std::vector<uint32_t> weights = {};
+
+    /// Get the string representation of the given scheduling
+    static inline const char* Scheduling2String(Scheduling scheduling)
+    {
+        switch (scheduling)
+        {
+            case kStrict:
+                return "strict";
+
+            case kWeighted:
+                return "weighted";
+        }
+
+        return "unknown";
+    }
+
+    ///
+    /// Parse the lane options specified on the command line
+    ///
+    /// @param string `strict`, `weighted` or `weighted:` followed by comma-separated weights such as `weighted:8,4,1`
+    /// @return The options on success, `std::nullopt` if the given string is malformed.
+    ///
+    static std::optional<LaneOptions> parse(const std::string& string)
+    {
+        static const std::string kWeightedPrefix = "weighted:";
+
+        if (string == Scheduling2String(kStrict))
+        {
+            return LaneOptions{ .scheduling = kStrict };
+        }
+
+        if (string == Scheduling2String(kWeighted))
+        {
+            return LaneOptions{ .scheduling = kWeighted };
+        }
+
+        if (!string.starts_with(kWeightedPrefix))
+        {
+            return std::nullopt;
+        }
+
+        LaneOptions options = { .scheduling = kWeighted };
+
+        const char* start = string.c_str() + kWeightedPrefix.size();
+
+        while (true)
+        {
+            char* end = nullptr;
+
+            unsigned long weight = strtoul(start, &end, 10);
+
+            if (end == start || weight == 0 || weight > UINT32_MAX || (*end != ',' && *end != '\0'))
+            {
+                return std::nullopt;
+            }
+
+            options.weights.push_back(static_cast<uint32_t>(weight));
+
+            if (*end == '\0')
+            {
+                return options;
+            }
+
+            start = end + 1;
+        }
+    }
+};
+
+///
+/// A set of bounded lock-free queues, called lanes, that are drained by a single consumer in the order of priority
+///
+/// @tparam Element Specify the type of each element
+/// @tparam LaneCount Specify the number of lanes, where lane 0 has the highest priority
+/// @tparam Coalescer Specify the type that assigns coalescing keys to elements (see `MPSCRingQueue`)
+/// @note Each lane is an independent `MPSCRingQueue` with its own bound and policy,
+///       so a burst in one lane never takes the room of another lane.
+///       The consumer sleeps on a single futex that the producers of all lanes signal.
+///       If coalescing is enabled, lanes share their mailboxes, so an element replaces the pending element of its key in any lane,
+///       and it is delivered no later than its own lane would deliver it.
+///
+template <typename Element, size_t LaneCount, typename Coalescer = NoCoalescing>
+struct LaneQueue
+{
+public:
+    /// The queue of a lane
+    using Lane = MPSCRingQueue<Element, Coalescer>;
+
+private:
+    /// The mailboxes shared by all lanes, which must outlive the lanes
+    typename Lane::Mailboxes mailboxes;
+
+    /// Lanes in the order of priority
+    std::array<Lane, LaneCount> lanes;
+
+    /// The wakeup shared by all lanes
+    ConsumerWakeup wakeup;
+
+    /// How the consumer picks the lane of the next element
+    LaneOptions::Scheduling scheduling;
+
+    /// The weight of each lane under the `kWeighted` scheduling
+    std::array<uint32_t, LaneCount> weights;
+
+    /// The lane visited by the consumer under the `kWeighted` scheduling
+    size_t current;
+
+    /// The number of elements that the consumer may still take from the current lane
+    uint32_t credits;
+
+    /// Create lanes that have the same options
+    template <size_t... Indices>
+    LaneQueue(const QueueOptions& queue, const LaneOptions& options, std::index_sequence<Indices...>)
+        : lanes{ ((void) Indices, Lane(queue))... }, scheduling(options.scheduling), current(0), credits(0)
+    {
+        for (size_t index = 0; index < LaneCount; index += 1)
+        {
+            this->lanes[index].shareWakeup(this->wakeup);
+
+            this->lanes[index].shareMailboxes(this->mailboxes, index);
+
+            this->weights[index] = index < options.weights.size() ? options.weights[index] : 1u << std::min<size_t>(LaneCount - 1 - index, 16);
+        }
+
+        this->credits = this->weights[0];
+    }
+
+    //
+    // MARK: - Constructor & Destructor
+    //
+
+public:
+    ///
+    /// Create empty lanes
+    ///
+    /// @param queue The capacity, the policy and the watermarks of each lane
+    /// @param options How the consumer picks the lane of the next element
+    ///
+    explicit LaneQueue(const QueueOptions& queue = {}, const LaneOptions& options = {})
+        : LaneQueue(queue, options, std::make_index_sequence<LaneCount>()) {}
+
+    /// The copy constructor is not available
+    LaneQueue(const LaneQueue& other) = delete;
+
+    /// Copy assignment is not available
+    LaneQueue& operator=(const LaneQueue& other) = delete;
+
+    //
+    // MARK: - Query Properties
+    //
+
+    ///
+    /// Get the queue of the given lane
+    ///
+    /// @param lane The index of the lane
+    /// @return The queue of the lane.
+    /// @note Use the returned queue to inspect the lane. Elements must be enqueued via `offer()` or `emplace()` of this class.
+    ///
+    [[nodiscard]]
+    const Lane& getLane(size_t lane) const
+    {
+        return this->lanes[lane];
+    }
+
+    ///
+    /// Get the queue of the given lane
+    ///
+    /// @param lane The index of the lane
+    /// @return The queue of the lane.
+    ///
+    [[nodiscard]]
+    Lane& getLane(size_t lane)
+    {
+        return this->lanes[lane];
+    }
+
+    ///
+    /// Get the number of elements in all lanes
+    ///
+    /// @return The element count.
+    /// @note This function is thread-safe but the result may be stale on return.
+    ///
+    [[nodiscard]]
+    size_t getCount() const
+    {
+        size_t count = 0;
+
+        for (const Lane& lane : this->lanes)
+        {
+            count += lane.getCount();
+        }
+
+        return count;
+    }
+
+    ///
+    /// Get the scheduling used by the consumer
+    ///
+    /// @return The scheduling.
+    ///
+    [[nodiscard]]
+    LaneOptions::Scheduling getScheduling() const
+    {
+        return this->scheduling;
+    }
+
+    ///
+    /// Get the weight of the given lane
+    ///
+    /// @param lane The index of the lane
+    /// @return The number of elements taken from the lane in a round under the `kWeighted` scheduling.
+    ///
+    [[nodiscard]]
+    uint32_t getWeight(size_t lane) const
+    {
+        return this->weights[lane];
+    }
+
+    //
+    // MARK: - Manage the Queue
+    //
+
+    ///
+    /// Append the given element to the end of the given lane
+    ///
+    /// @param lane The index of the lane
+    /// @param element The element to be enqueued
+    /// @return `true` if the element is enqueued or replaces a pending one, `false` if it is discarded by the policy of the lane.
+    ///
+    bool offer(size_t lane, Element element)
+    {
+        return this->lanes[lane].offer(std::move(element));
+    }
+
+    ///
+    /// Append the given element to the end of the given lane without waiting for room
+    ///
+    /// @param lane The index of the lane
+    /// @param element The element to be enqueued
+    /// @return `true` if the element is enqueued or replaces a pending one, `false` if it is discarded because the lane is full.
+    ///
+    bool tryOffer(size_t lane, Element element)
+    {
+        return this->lanes[lane].tryOffer(std::move(element));
+    }
+
+    ///
+    /// Construct an element at the end of the given lane
+    ///
+    /// @param lane The index of the lane
+    /// @param args Arguments to forward to the constructor of `Element`
+    /// @return `true` if the element is enqueued or replaces a pending one, `false` if it is discarded by the policy of the lane.
+    ///
+    template <typename... Args>
+    bool emplace(size_t lane, Args&&... args)
+    {
+        return this->lanes[lane].emplace(std::forward<Args>(args)...);
+    }
+
+    ///
+    /// Remove the next element picked by the scheduling without waiting
+    ///
+    /// @return The element on success, `std::nullopt` if all lanes are empty.
+    /// @note Only the consumer thread may call this function.
+    ///
+    std::optional<Element> tryPoll()
+    {
+        if (this->scheduling == LaneOptions::kStrict)
+        {
+            for (Lane& lane : this->lanes)
+            {
+                if (auto element = lane.tryPoll())
+                {
+                    return element;
+                }
+            }
+
+            return std::nullopt;
+        }
+
+        // Visit each lane at most once, moving on once the current lane is empty or has used up its weight
+        for (size_t visited = 0; visited <= LaneCount; visited += 1)
+        {
+            if (this->credits != 0)
+            {
+                if (auto element = this->lanes[this->current].tryPoll())
+                {
+                    this->credits -= 1;
+
+                    return element;
+                }
+            }
+
+            this->current = (this->current + 1) % LaneCount;
+
+            this->credits = this->weights[this->current];
+        }
+
+        return std::nullopt;
+    }
+
+    ///
+    /// Remove the next element picked by the scheduling
+    ///
+    /// @return The element.
+    /// @note Only the consumer thread may call this function.
+    ///
+    Element poll()
+    {
+        while (true)
+        {
+            auto element = this->pollWithTimeout(std::chrono::nanoseconds(-1));
+
+            if (element)
+            {
+                return std::move(*element);
+            }
+        }
+    }
+
+    ///
+    /// Remove the available elements in the order picked by the scheduling without waiting and append them to the given container
+    ///
+    /// @param container A container that supports `push_back`
+    /// @param maxCount The maximum number of elements to remove
+    /// @return The number of elements removed.
+    /// @note Only the consumer thread may call this function.
+    ///
+    template <typename Container>
+    size_t drainTo(Container& container, size_t maxCount = SIZE_MAX)
+    {
+        size_t count = 0;
+
+        while (count < maxCount)
+        {
+            auto element = this->tryPoll();
+
+            if (!element)
+            {
+                break;
+            }
+
+            container.push_back(std::move(*element));
+
+            count += 1;
+        }
+
+        return count;
+    }
+
+    ///
+    /// Wait up to the specified amount of time to remove the next element picked by the scheduling
+    ///
+    /// @param timeout The amount of time to wait until any lane is non-empty, or a negative value to wait indefinitely
+    /// @return The element on success, `std::nullopt` on timed out.
+    /// @note Only the consumer thread may call this function.
+    ///
+    template <typename Representation, typename Period>
+    std::optional<Element> pollWithTimeout(const std::chrono::duration<Representation, Period>& timeout)
+    {
+        // Fast path: A lane is not empty
+        if (auto element = this->tryPoll())
+        {
+            return element;
+        }
+
+        if (timeout.count() == 0)
+        {
+            return std::nullopt;
+        }
+
+        auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(timeout);
+
+        auto deadline = std::chrono::steady_clock::now() + duration;
+
+        while (true)
+        {
+            // Announce that the consumer is about to sleep and check all lanes again
+            uint32_t ticket = this->wakeup.nonempty.load();
+
+            this->wakeup.sleeping.store(true, std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            if (auto element = this->tryPoll())
+            {
+                this->wakeup.sleeping.store(false, std::memory_order_relaxed);
+
+                return element;
+            }
+
+            if (duration.count() < 0)
+            {
+                this->wakeup.nonempty.wait(ticket);
+            }
+            else
+            {
+                auto remaining = deadline - std::chrono::steady_clock::now();
+
+                if (remaining.count() <= 0)
+                {
+                    this->wakeup.sleeping.store(false, std::memory_order_relaxed);
+
+                    return std::nullopt;
+                }
+
+                this->wakeup.nonempty.wait(ticket, std::chrono::duration_cast<std::chrono::nanoseconds>(remaining));
+            }
+
+            this->wakeup.sleeping.store(false, std::memory_order_relaxed);
+
+            if (auto element = this->tryPoll())
+            {
+                return element;
+            }
+        }
+    }
+};
+
+#endif /* LaneQueue_hpp */
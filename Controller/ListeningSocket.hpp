@@ -0,0 +1,226 @@
+//
+//  ListeningSocket.hpp
+//  Controller
+//
+//  Created by FireWolf on 10/15/26.
+//
+
+#ifndef ListeningSocket_hpp
+#define ListeningSocket_hpp
+
+#include "StreamSocket.hpp"
+
+///
+/// A socket that accepts connections from emulated devices
+///
+/// @note The socket is non-blocking, so the caller should wait until it becomes readable before accepting a connection.
+///
+struct ListeningSocket
+{
+private:
+    /// The socket descriptor managed by this class
+    int descriptor;
+
+    ///
+    /// Put the given descriptor into non-blocking mode and close it when the process executes another program
+    ///
+    /// @param descriptor A socket descriptor
+    /// @return `true` on success, `false` otherwise.
+    /// @note `SOCK_NONBLOCK`, `SOCK_CLOEXEC` and `accept4()` would do the same atomically but are not available on macOS.
+    ///
+    static bool configure(int descriptor)
+    {
+        int flags = fcntl(descriptor, F_GETFL);
+
+        return flags >= 0 && fcntl(descriptor, F_SETFL, flags | O_NONBLOCK) == 0 && fcntl(descriptor, F_SETFD, FD_CLOEXEC) == 0;
+    }
+
+    ///
+    /// Bind the socket to the given address and start listening
+    ///
+    /// @param address The socket address
+    /// @param description A human-readable description of the address
+    /// @throws SocketException if failed to bind the socket to the given address;
+    ///                         if failed to listen on the socket.
+    ///
+    template <typename Address>
+    void listen(const Address& address, const std::string& description)
+    {
+        // Guard: Bind the socket to the given address
+        if (bind(this->descriptor, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+        {
+            close(this->descriptor);
+
+            throw SocketException("Failed to bind the socket to {}. Reason: {}.", description, strerror(errno));
+        }
+
+        // Guard: Listen for connections
+        if (::listen(this->descriptor, SOMAXCONN) != 0)
+        {
+            close(this->descriptor);
+
+            throw SocketException("Failed to listen on {}. Reason: {}.", description, strerror(errno));
+        }
+    }
+
+    //
+    // MARK: - Constructor & Destructor
+    //
+
+public:
+    ///
+    /// Create a socket that listens on the given IPv4 address
+    ///
+    /// @param local The socket address on the local machine
+    /// @throws SocketException if failed to create the socket descriptor;
+    ///                         if failed to bind the socket to the given address;
+    ///                         if failed to listen on the socket.
+    ///
+    explicit ListeningSocket(SocketAddress4 local)
+    {
+        // Guard: Create a socket descriptor
+        this->descriptor = socket(PF_INET, SOCK_STREAM, 0);
+
+        if (this->descriptor < 0)
+        {
+            throw SocketException("Failed to create a socket descriptor.");
+        }
+
+        if (!configure(this->descriptor))
+        {
+            close(this->descriptor);
+
+            throw SocketException("Failed to configure the socket descriptor. Reason: {}.", strerror(errno));
+        }
+
+        int enabled = 1;
+
+        setsockopt(this->descriptor, SOL_SOCKET, SO_REUSEADDR, &enabled, sizeof(enabled));
+
+        this->listen(SocketAddressConverter{}(local), SocketAddressPrinter{}(local));
+    }
+
+    ///
+    /// Create a socket that listens on the given Unix domain socket
+    ///
+    /// @param local The path of the Unix domain socket on the local machine
+    /// @throws SocketException if the path is too long;
+    ///                         if failed to create the socket descriptor;
+    ///                         if failed to bind the socket to the given path;
+    ///                         if failed to listen on the socket.
+    /// @note A stale socket left at the given path is removed.
+    ///
+    explicit ListeningSocket(const SocketAddressUnix& local)
+    {
+        // Guard: The path must fit in the socket address
+        if (local.path.size() >= sizeof(sockaddr_un::sun_path))
+        {
+            throw SocketException("The path of the Unix domain socket {} is too long.", local.path);
+        }
+
+        // Guard: Create a socket descriptor
+        this->descriptor = socket(PF_UNIX, SOCK_STREAM, 0);
+
+        if (this->descriptor < 0)
+        {
+            throw SocketException("Failed to create a socket descriptor.");
+        }
+
+        if (!configure(this->descriptor))
+        {
+            close(this->descriptor);
+
+            throw SocketException("Failed to configure the socket descriptor. Reason: {}.", strerror(errno));
+        }
+
+        struct stat status = {};
+
+        if (stat(local.path.c_str(), &status) == 0 && S_ISSOCK(status.st_mode))
+        {
+            unlink(local.path.c_str());
+        }
+
+        this->listen(SocketAddressConverter{}(local), SocketAddressPrinter{}(local));
+    }
+
+    /// The copy constructor is not available
+    ListeningSocket(const ListeningSocket& other) = delete;
+
+    /// The move constructor transfers the ownership of the managed socket descriptor
+    ListeningSocket(ListeningSocket&& other) noexcept : descriptor(other.descriptor)
+    {
+        other.descriptor = -1;
+    }
+
+    ///
+    /// Release the listening socket
+    ///
+    /// @note The destructor closes the managed socket if the descriptor is valid.
+    ///
+    ~ListeningSocket()
+    {
+        if (this->descriptor >= 0)
+        {
+            close(this->descriptor);
+        }
+    }
+
+    /// Copy assignment is not available
+    ListeningSocket& operator=(const ListeningSocket& other) = delete;
+
+    /// Move assignment is not available
+    ListeningSocket& operator=(ListeningSocket&& other) = delete;
+
+    //
+    // MARK: - Query Properties
+    //
+
+    ///
+    /// Get the socket descriptor managed by this class
+    ///
+    /// @return The socket descriptor.
+    /// @note The ownership of the descriptor is not transferred to the caller.
+    ///
+    [[nodiscard]]
+    int getDescriptor() const
+    {
+        return this->descriptor;
+    }
+
+    //
+    // MARK: - Accept Connections
+    //
+
+    ///
+    /// Accept a pending connection
+    ///
+    /// @return A non-blocking stream socket connected to the device on success, `std::nullopt` if no connection is pending.
+    /// @throws SocketException if failed to accept the connection for a reason other than the lack of pending connections.
+    ///
+    std::optional<StreamSocket> accept() const
+    {
+        int result = ::accept(this->descriptor, nullptr, nullptr);
+
+        if (result >= 0)
+        {
+            // The socket takes the ownership first, so the descriptor is closed if it cannot be configured
+            StreamSocket socket(result);
+
+            if (!configure(result))
+            {
+                throw SocketException("Failed to configure the accepted connection. Reason: {}.", strerror(errno));
+            }
+
+            return socket;
+        }
+
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR || errno == ECONNABORTED)
+        {
+            return std::nullopt;
+        }
+
+        throw SocketException("Failed to accept a connection. Reason: {}.", strerror(errno));
+    }
+};
+
+#endif /* ListeningSocket_hpp */
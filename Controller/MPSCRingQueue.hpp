@@ -0,0 +1,1032 @@
+//
+//  MPSCRingQueue.hpp
+//  Controller
+//
+//  Created by FireWolf on 10/15/26.
+//
+
+#ifndef MPSCRingQueue_hpp
+#define MPSCRingQueue_hpp
+
+#include "Futex.hpp"
+#include <memory>
+#include <new>
+#include <optional>
+#include <thread>
+#include <bit>
+#include <algorithm>
+#include <array>
+#include <string>
+#include <cstdint>
+
+/// Options that bound a queue and decide what producers do once it is full
+struct QueueOptions
+{
+    /// What a producer does if the queue is full
+    enum Policy
+    {
+        /// The producer sleeps until the consumer makes room
+        kBlock,
+
+        /// The oldest element is discarded to make room for the new one
+        kDropOldest,
+
+        /// The new element is discarded
+        kDropNewest,
+
+        /// The same as `kBlock` with coalescing enabled
+        kCoalesce,
+    };
+
+    /// The maximum number of elements which is rounded up to a power of 2
+    size_t capacity = 1024;
+
+    /// What a producer does if the queue is full
+    Policy policy = kBlock;
+
+    /// `true` if an element that has a coalescing key replaces the pending element with the same key,
+    /// `false` if every element keeps its own slot
+    /// @note Elements without a coalescing key keep their order regardless of this option.
+    bool coalesce = false;
+
+    /// The number of elements at or above which the queue reports the high watermark, or 0 for 3/4 of the capacity
+    size_t highWatermark = 0;
+
+    /// The number of elements at or below which the queue reports the low watermark after the high one, or 0 for 1/4 of the capacity
+    size_t lowWatermark = 0;
+
+    /// Get the string representation of the given policy
+    static inline const char* Policy2String(Policy policy)
+    {
+        switch (policy)
+        {
+            case kBlock:
+                return "block";
+
+            case kDropOldest:
+                return "drop-oldest";
+
+            case kDropNewest:
+                return "drop-newest";
+
+            case kCoalesce:
+                return "coalesce";
+        }
+
+        return "unknown";
+    }
+
+    ///
+    /// Parse the given policy
+    ///
+    /// @param string One of `block`, `drop-oldest`, `drop-newest` and `coalesce`
+    /// @return The policy on success, `std::nullopt` if the given string is not a policy.
+    ///
+    static std::optional<Policy> parsePolicy(const std::string& string)
+    {
+        for (Policy policy : { kBlock, kDropOldest, kDropNewest, kCoalesce })
+        {
+            if (string == Policy2String(policy))
+            {
+                return policy;
+            }
+        }
+
+        return std::nullopt;
+    }
+};
+
+/// The state shared by a consumer that sleeps until a queue becomes non-empty and the producers of that queue
+struct ConsumerWakeup
+{
+    /// `true` if the consumer is about to sleep or is sleeping
+    alignas(64) std::atomic<bool> sleeping = false;
+
+    /// The futex on which the consumer sleeps
+    Futex nonempty;
+};
+
+/// A coalescer that never assigns a key to an element
+struct NoCoalescing
+{
+    /// The number of distinct coalescing keys
+    static constexpr size_t kKeyCount = 0;
+
+    /// Get the coalescing key of the given element
+    template <typename Element>
+    static std::optional<size_t> getKey(const Element&)
+    {
+        return std::nullopt;
+    }
+};
+
+///
+/// A bounded lock-free queue that supports multiple producers and a single consumer
+///
+/// @tparam Element Specify the type of each element
+/// @tparam Coalescer Specify the type that assigns a key less than `Coalescer::kKeyCount` to elements that may replace each other
+///                   if coalescing is enabled via `static std::optional<size_t> getKey(const Element&)`
+/// @note Producers claim slots without taking a lock, and the consumer sleeps on a futex only when the queue is empty.
+///       What a producer does once the queue is full depends on the policy specified at construction.
+///       If coalescing is enabled, producers and the consumer serialize on a spinlock per coalescing key
+///       while they deposit, withdraw or collect an element that has the key.
+///       The lock is held only to copy or move the element, but a producer preempted while it holds the lock stalls the consumer
+///       once the consumer reaches a slot of the same key. Elements without a coalescing key never take the lock.
+///
+template <typename Element, typename Coalescer = NoCoalescing>
+struct MPSCRingQueue
+{
+public:
+    /// Counters that describe how the queue has coped with its bound
+    struct Statistics
+    {
+        /// The number of elements enqueued so far, including those dropped later
+        uint64_t enqueued;
+
+        /// The number of elements removed by the consumer so far
+        uint64_t dequeued;
+
+        /// The number of elements discarded by the `kDropOldest` policy
+        uint64_t droppedOldest;
+
+        /// The number of elements discarded by the `kDropNewest` policy, or by `tryOffer()` instead of waiting for room
+        uint64_t droppedNewest;
+
+        /// The number of elements that replaced a pending element with the same coalescing key
+        uint64_t coalesced;
+
+        /// The number of times a producer has slept because the queue was full
+        uint64_t blocked;
+
+        /// The number of times the queue has reached the high watermark
+        uint64_t highWatermarks;
+
+        /// The number of times the queue has fallen to the low watermark after reaching the high one
+        uint64_t lowWatermarks;
+    };
+
+    /// The latest pending element with a coalescing key
+    struct Mailbox
+    {
+        /// The lock that serializes producers that deposit and the consumer that collects the element
+        std::atomic_flag lock;
+
+        /// The latest element, or `std::nullopt` if it has been delivered or no slot refers to the mailbox
+        std::optional<Element> latest;
+
+        /// The number of slots that refer to the mailbox in all queues that share it
+        size_t references = 0;
+
+        /// The rank of the queue that has enqueued the latest slot that refers to the mailbox
+        size_t rank = 0;
+    };
+
+    /// Mailboxes indexed by coalescing keys
+    using Mailboxes = std::array<Mailbox, Coalescer::kKeyCount>;
+
+private:
+    /// The size of a cache line
+    static constexpr size_t kCacheLineSize = 64;
+
+    /// A slot in the ring
+    struct Slot
+    {
+        /// The position at which the slot can be written (== position) or read (== position + 1)
+        std::atomic<size_t> sequence;
+
+        /// The storage of the element
+        alignas(Element) unsigned char storage[sizeof(Element)];
+
+        /// Get the element stored in the slot
+        Element* getElement()
+        {
+            return std::launder(reinterpret_cast<Element*>(this->storage));
+        }
+    };
+
+    /// The ring of slots
+    std::unique_ptr<Slot[]> slots;
+
+    /// The mask that maps a position to the index of a slot
+    size_t mask;
+
+    /// What a producer does if the queue is full
+    QueueOptions::Policy policy;
+
+    /// `true` if elements that have a coalescing key replace each other while pending
+    bool coalescing;
+
+    /// The number of elements at or above which the queue records the high watermark
+    size_t highWatermark;
+
+    /// The number of elements at or below which the queue records the low watermark
+    size_t lowWatermark;
+
+    /// The mailboxes used unless the queue shares others with queues of other priorities
+    Mailboxes ownMailboxes;
+
+    /// The mailboxes in which elements that have a coalescing key are deposited
+    Mailboxes* mailboxes;
+
+    /// The priority of the queue among those that share the mailboxes, where 0 is the highest
+    size_t rank;
+
+    /// The position of the next slot to be claimed by producers
+    alignas(kCacheLineSize) std::atomic<size_t> enqueuePosition;
+
+    /// The position of the next slot to be read by the consumer
+    alignas(kCacheLineSize) std::atomic<size_t> dequeuePosition;
+
+    /// The wakeup used by the consumer unless it shares another one with other queues
+    ConsumerWakeup ownWakeup;
+
+    /// The wakeup on which the consumer sleeps
+    ConsumerWakeup* wakeup;
+
+    /// The number of producers that are about to sleep or are sleeping because the queue is full
+    alignas(kCacheLineSize) std::atomic<uint32_t> waiters;
+
+    /// The futex on which producers sleep
+    Futex nonfull;
+
+    /// `true` if the queue has reached the high watermark but not yet fallen to the low one
+    std::atomic<bool> congested;
+
+    /// Counters that are updated only when the queue is full or crosses a watermark
+    std::atomic<uint64_t> droppedOldest, droppedNewest, coalesced, blocked, highWatermarks, lowWatermarks;
+
+    ///
+    /// Record the high watermark if the queue has just reached it
+    ///
+    /// @note Only a counter is updated on the producer thread, and whoever reports the crossing reads it from the statistics.
+    ///
+    void checkHighWatermark()
+    {
+        if (this->getCount() >= this->highWatermark && !this->congested.load(std::memory_order_relaxed) && !this->congested.exchange(true))
+        {
+            this->highWatermarks.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    ///
+    /// Wake up the producers that wait for room and record the low watermark if the queue has just fallen to it
+    ///
+    /// @note The caller must have released a slot.
+    ///
+    void checkLowWatermark()
+    {
+        if (this->policy == QueueOptions::kBlock || this->policy == QueueOptions::kCoalesce)
+        {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            if (this->waiters.load(std::memory_order_relaxed) != 0)
+            {
+                this->nonfull.signal();
+            }
+        }
+
+        if (!this->congested.load(std::memory_order_relaxed))
+        {
+            return;
+        }
+
+        if (this->getCount() <= this->lowWatermark && this->congested.exchange(false))
+        {
+            this->lowWatermarks.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    ///
+    /// Sleep until the consumer releases the given slot
+    ///
+    /// @param slot The slot that the producer has found occupied
+    /// @param position The position at which the producer wants to write the slot
+    ///
+    void waitForRoom(Slot* slot, size_t position)
+    {
+        uint32_t ticket = this->nonfull.load();
+
+        this->waiters.fetch_add(1, std::memory_order_seq_cst);
+
+        // The consumer may have released the slot before it noticed the waiter
+        if (static_cast<intptr_t>(slot->sequence.load(std::memory_order_seq_cst)) - static_cast<intptr_t>(position) < 0)
+        {
+            this->nonfull.wait(ticket);
+        }
+
+        this->waiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    ///
+    /// Discard the head of the queue to make room for a new element
+    ///
+    /// @note The function fails if the consumer takes the head first or the head is still being written,
+    ///       in which case the caller should try to claim a slot again.
+    ///
+    void evict()
+    {
+        size_t position = this->dequeuePosition.load(std::memory_order_relaxed);
+
+        Slot& slot = this->slots[position & this->mask];
+
+        if (slot.sequence.load(std::memory_order_acquire) != position + 1 ||
+            !this->dequeuePosition.compare_exchange_strong(position, position + 1, std::memory_order_relaxed))
+        {
+            std::this_thread::yield();
+
+            return;
+        }
+
+        Element element(std::move(*slot.getElement()));
+
+        slot.getElement()->~Element();
+
+        slot.sequence.store(position + this->mask + 1, std::memory_order_release);
+
+        if constexpr (Coalescer::kKeyCount != 0)
+        {
+            if (this->coalescing)
+            {
+                if (auto key = Coalescer::getKey(element))
+                {
+                    this->withdraw(*key);
+                }
+            }
+        }
+
+        this->droppedOldest.fetch_add(1, std::memory_order_relaxed);
+
+        this->checkLowWatermark();
+    }
+
+    ///
+    /// Deposit the given element in the mailbox of the given key
+    ///
+    /// @param key The coalescing key of the element
+    /// @param element The element to deposit
+    /// @return `true` if the caller must enqueue a slot that refers to the mailbox, `false` if the element has replaced the pending one.
+    /// @note If the pending element was enqueued by a queue of a lower priority, the element still replaces it,
+    ///       but the caller enqueues another slot so that the element is not delayed by the other queue.
+    ///
+    bool deposit(size_t key, const Element& element)
+    {
+        Mailbox& mailbox = (*this->mailboxes)[key];
+
+        while (mailbox.lock.test_and_set(std::memory_order_acquire))
+        {
+            std::this_thread::yield();
+        }
+
+        bool pending = mailbox.latest.has_value();
+
+        bool enqueue = !pending || this->rank < mailbox.rank;
+
+        mailbox.latest.emplace(element);
+
+        if (enqueue)
+        {
+            mailbox.references += 1;
+
+            mailbox.rank = this->rank;
+        }
+
+        mailbox.lock.clear(std::memory_order_release);
+
+        if (pending)
+        {
+            this->coalesced.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        return enqueue;
+    }
+
+    ///
+    /// Withdraw a slot that refers to the mailbox of the given key because it cannot be enqueued or is discarded
+    ///
+    /// @param key The coalescing key of the element
+    /// @return `true` if another slot still delivers the latest element, `false` if it is discarded along with the slot.
+    ///
+    bool withdraw(size_t key)
+    {
+        Mailbox& mailbox = (*this->mailboxes)[key];
+
+        while (mailbox.lock.test_and_set(std::memory_order_acquire))
+        {
+            std::this_thread::yield();
+        }
+
+        mailbox.references -= 1;
+
+        if (mailbox.references == 0)
+        {
+            mailbox.latest.reset();
+        }
+
+        bool pending = mailbox.latest.has_value();
+
+        mailbox.lock.clear(std::memory_order_release);
+
+        return pending;
+    }
+
+    ///
+    /// Replace the given element removed from the ring with the latest element deposited in its mailbox
+    ///
+    /// @param element An element removed from the ring
+    /// @return `true` if the element should be delivered, `false` if another slot has already delivered the latest element of its key.
+    ///
+    bool collect(Element& element)
+    {
+        if constexpr (Coalescer::kKeyCount != 0)
+        {
+            if (!this->coalescing)
+            {
+                return true;
+            }
+
+            auto key = Coalescer::getKey(element);
+
+            if (!key)
+            {
+                return true;
+            }
+
+            Mailbox& mailbox = (*this->mailboxes)[*key];
+
+            while (mailbox.lock.test_and_set(std::memory_order_acquire))
+            {
+                std::this_thread::yield();
+            }
+
+            mailbox.references -= 1;
+
+            bool pending = mailbox.latest.has_value();
+
+            if (pending)
+            {
+                element = std::move(*mailbox.latest);
+
+                mailbox.latest.reset();
+            }
+
+            mailbox.lock.clear(std::memory_order_release);
+
+            return pending;
+        }
+
+        return true;
+    }
+
+    ///
+    /// Construct an element in a slot at the end of the queue
+    ///
+    /// @param wait Pass `false` to discard the element instead of waiting for room under the `kBlock` and `kCoalesce` policies
+    /// @param args Arguments to forward to the constructor of `Element`
+    /// @return `true` on success, `false` if the element is discarded by the `kDropNewest` policy or instead of waiting.
+    ///
+    template <typename... Args>
+    bool push(bool wait, Args&&... args)
+    {
+        size_t position = this->enqueuePosition.load(std::memory_order_relaxed);
+
+        Slot* slot;
+
+        bool waited = false;
+
+        // Claim a slot
+        while (true)
+        {
+            slot = &this->slots[position & this->mask];
+
+            size_t sequence = slot->sequence.load(std::memory_order_acquire);
+
+            auto difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+
+            if (difference == 0)
+            {
+                if (this->enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (difference < 0)
+            {
+                // The queue is full
+                switch (this->policy)
+                {
+                    case QueueOptions::kDropNewest:
+                    {
+                        this->droppedNewest.fetch_add(1, std::memory_order_relaxed);
+
+                        return false;
+                    }
+
+                    case QueueOptions::kDropOldest:
+                    {
+                        this->evict();
+
+                        break;
+                    }
+
+                    case QueueOptions::kBlock:
+                    case QueueOptions::kCoalesce:
+                    {
+                        if (!wait)
+                        {
+                            this->droppedNewest.fetch_add(1, std::memory_order_relaxed);
+
+                            return false;
+                        }
+
+                        if (!waited)
+                        {
+                            this->blocked.fetch_add(1, std::memory_order_relaxed);
+
+                            waited = true;
+                        }
+
+                        this->waitForRoom(slot, position);
+
+                        break;
+                    }
+                }
+
+                position = this->enqueuePosition.load(std::memory_order_relaxed);
+            }
+            else
+            {
+                // Another producer has claimed the slot
+                position = this->enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+
+        // Publish the element
+        new (slot->storage) Element(std::forward<Args>(args)...);
+
+        slot->sequence.store(position + 1, std::memory_order_release);
+
+        // Wake up the consumer if it is about to sleep
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (this->wakeup->sleeping.load(std::memory_order_relaxed))
+        {
+            this->wakeup->nonempty.signal();
+        }
+
+        this->checkHighWatermark();
+
+        return true;
+    }
+
+    ///
+    /// Construct an element at the end of the queue, depositing it in its mailbox if coalescing is enabled
+    ///
+    /// @param wait Pass `false` to discard the element instead of waiting for room under the `kBlock` and `kCoalesce` policies
+    /// @param args Arguments to forward to the constructor of `Element`
+    /// @return `true` if the element is enqueued or replaces a pending one, `false` if it is discarded.
+    ///
+    template <typename... Args>
+    bool insert(bool wait, Args&&... args)
+    {
+        if constexpr (Coalescer::kKeyCount != 0)
+        {
+            if (this->coalescing)
+            {
+                Element element(std::forward<Args>(args)...);
+
+                auto key = Coalescer::getKey(element);
+
+                if (!key)
+                {
+                    return this->push(wait, std::move(element));
+                }
+
+                if (!this->deposit(*key, element))
+                {
+                    return true;
+                }
+
+                // Guard: The slot is discarded by the `kDropNewest` policy or instead of waiting for room
+                if (!this->push(wait, std::move(element)))
+                {
+                    return this->withdraw(*key);
+                }
+
+                return true;
+            }
+        }
+
+        return this->push(wait, std::forward<Args>(args)...);
+    }
+
+    ///
+    /// Remove the element in the head slot without waiting
+    ///
+    /// @return The element in the head slot on success, `std::nullopt` if the queue is empty.
+    /// @note Only the consumer thread may call this function. The caller must collect the latest element of its coalescing key.
+    ///
+    std::optional<Element> pollSlot()
+    {
+        size_t position = this->dequeuePosition.load(std::memory_order_relaxed);
+
+        Slot* slot;
+
+        // Claim the head slot which producers may also claim under the `kDropOldest` policy
+        while (true)
+        {
+            slot = &this->slots[position & this->mask];
+
+            auto difference = static_cast<intptr_t>(slot->sequence.load(std::memory_order_acquire)) - static_cast<intptr_t>(position + 1);
+
+            if (difference == 0)
+            {
+                if (this->dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (difference < 0)
+            {
+                // The queue is empty
+                return std::nullopt;
+            }
+            else
+            {
+                // A producer has discarded the head
+                position = this->dequeuePosition.load(std::memory_order_relaxed);
+            }
+        }
+
+        std::optional<Element> element(std::move(*slot->getElement()));
+
+        slot->getElement()->~Element();
+
+        slot->sequence.store(position + this->mask + 1, std::memory_order_release);
+
+        this->checkLowWatermark();
+
+        return element;
+    }
+
+    //
+    // MARK: - Constructor & Destructor
+    //
+
+public:
+    ///
+    /// Create an empty queue
+    ///
+    /// @param options The capacity, the policy applied once the queue is full and the watermarks
+    ///
+    explicit MPSCRingQueue(const QueueOptions& options = {})
+    {
+        size_t capacity = std::bit_ceil(std::max<size_t>(options.capacity, 2));
+
+        this->slots = std::make_unique<Slot[]>(capacity);
+
+        this->mask = capacity - 1;
+
+        this->policy = options.policy;
+
+        this->coalescing = options.coalesce || options.policy == QueueOptions::kCoalesce;
+
+        this->highWatermark = std::min(options.highWatermark == 0 ? capacity * 3 / 4 : options.highWatermark, capacity);
+
+        this->lowWatermark = std::min(options.lowWatermark == 0 ? capacity / 4 : options.lowWatermark, this->highWatermark - 1);
+
+        for (size_t index = 0; index < capacity; index += 1)
+        {
+            this->slots[index].sequence.store(index, std::memory_order_relaxed);
+        }
+
+        this->enqueuePosition.store(0, std::memory_order_relaxed);
+
+        this->dequeuePosition.store(0, std::memory_order_relaxed);
+
+        this->wakeup = &this->ownWakeup;
+
+        this->mailboxes = &this->ownMailboxes;
+
+        this->rank = 0;
+
+        this->waiters.store(0, std::memory_order_relaxed);
+
+        this->congested.store(false, std::memory_order_relaxed);
+
+        for (auto* counter : { &this->droppedOldest, &this->droppedNewest, &this->coalesced, &this->blocked, &this->highWatermarks, &this->lowWatermarks })
+        {
+            counter->store(0, std::memory_order_relaxed);
+        }
+    }
+
+    /// The copy constructor is not available
+    MPSCRingQueue(const MPSCRingQueue& other) = delete;
+
+    /// Copy assignment is not available
+    MPSCRingQueue& operator=(const MPSCRingQueue& other) = delete;
+
+    /// Destroy the elements remaining in the queue
+    ~MPSCRingQueue()
+    {
+        while (this->tryPoll()) {}
+    }
+
+    //
+    // MARK: - Query Properties
+    //
+
+    ///
+    /// Check whether the queue is empty
+    ///
+    /// @return `true` if the queue is empty, `false` otherwise.
+    /// @note This function is thread-safe but the result may be stale on return.
+    ///
+    [[nodiscard]]
+    bool isEmpty() const
+    {
+        return this->getCount() == 0;
+    }
+
+    ///
+    /// Get the number of elements in the queue
+    ///
+    /// @return The element count including those being written by producers.
+    /// @note This function is thread-safe but the result may be stale on return.
+    ///
+    [[nodiscard]]
+    size_t getCount() const
+    {
+        size_t dequeue = this->dequeuePosition.load(std::memory_order_acquire);
+
+        size_t enqueue = this->enqueuePosition.load(std::memory_order_acquire);
+
+        return enqueue > dequeue ? enqueue - dequeue : 0;
+    }
+
+    ///
+    /// Get the maximum number of elements in the queue
+    ///
+    /// @return The capacity.
+    ///
+    [[nodiscard]]
+    size_t getCapacity() const
+    {
+        return this->mask + 1;
+    }
+
+    ///
+    /// Get the policy applied once the queue is full
+    ///
+    /// @return The policy.
+    ///
+    [[nodiscard]]
+    QueueOptions::Policy getPolicy() const
+    {
+        return this->policy;
+    }
+
+    ///
+    /// Check whether elements that have a coalescing key replace each other while pending
+    ///
+    /// @return `true` if coalescing is enabled, `false` otherwise.
+    ///
+    [[nodiscard]]
+    bool isCoalescing() const
+    {
+        return this->coalescing;
+    }
+
+    ///
+    /// Get the counters that describe how the queue has coped with its bound
+    ///
+    /// @return A snapshot of the counters.
+    /// @note This function is thread-safe but the counters may be stale on return.
+    ///
+    [[nodiscard]]
+    Statistics getStatistics() const
+    {
+        uint64_t droppedOldest = this->droppedOldest.load(std::memory_order_relaxed);
+
+        return
+        {
+            .enqueued = this->enqueuePosition.load(std::memory_order_relaxed),
+            .dequeued = this->dequeuePosition.load(std::memory_order_relaxed) - droppedOldest,
+            .droppedOldest = droppedOldest,
+            .droppedNewest = this->droppedNewest.load(std::memory_order_relaxed),
+            .coalesced = this->coalesced.load(std::memory_order_relaxed),
+            .blocked = this->blocked.load(std::memory_order_relaxed),
+            .highWatermarks = this->highWatermarks.load(std::memory_order_relaxed),
+            .lowWatermarks = this->lowWatermarks.load(std::memory_order_relaxed),
+        };
+    }
+
+    ///
+    /// Let the consumer sleep on the given wakeup, which is shared with other queues that the consumer drains
+    ///
+    /// @param shared The wakeup signaled by the producers of all queues
+    /// @note Call this function before any thread starts to use the queue.
+    ///
+    void shareWakeup(ConsumerWakeup& shared)
+    {
+        this->wakeup = &shared;
+    }
+
+    ///
+    /// Deposit elements that have a coalescing key in the given mailboxes, which are shared with other queues of the same consumer
+    ///
+    /// @param shared The mailboxes of all queues
+    /// @param rank The priority of the queue among those that share the mailboxes, where 0 is the highest
+    /// @note Call this function before any thread starts to use the queue.
+    ///       An element then replaces the pending element of its key in any of the queues,
+    ///       so the consumer never receives an element after a newer one of the same key enqueued in another queue.
+    ///
+    void shareMailboxes(Mailboxes& shared, size_t rank)
+    {
+        this->mailboxes = &shared;
+
+        this->rank = rank;
+    }
+
+    //
+    // MARK: - Manage the Queue
+    //
+
+    ///
+    /// Append the given element to the end of the queue
+    ///
+    /// @param element The element to be enqueued
+    /// @return `true` if the element is enqueued or replaces a pending one, `false` if it is discarded by the `kDropNewest` policy.
+    ///
+    bool offer(Element element)
+    {
+        return this->emplace(std::move(element));
+    }
+
+    ///
+    /// Construct an element at the end of the queue
+    ///
+    /// @param args Arguments to forward to the constructor of `Element`
+    /// @return `true` if the element is enqueued or replaces a pending one, `false` if it is discarded by the `kDropNewest` policy.
+    /// @note If coalescing is enabled, an element that has a coalescing key is deposited in the mailbox of its key,
+    ///       and the slot enqueued by the first pending element of that key delivers the latest one.
+    ///       Under the `kDropOldest` policy, discarding that slot discards the latest element of its key
+    ///       unless a slot in another queue that shares the mailboxes still refers to it.
+    ///
+    template <typename... Args>
+    bool emplace(Args&&... args)
+    {
+        return this->insert(true, std::forward<Args>(args)...);
+    }
+
+    ///
+    /// Append the given element to the end of the queue without waiting for room
+    ///
+    /// @param element The element to be enqueued
+    /// @return `true` if the element is enqueued or replaces a pending one, `false` if it is discarded.
+    /// @note Under the `kBlock` and `kCoalesce` policies, the element is discarded and counted as `droppedNewest` if the queue is full.
+    ///       Other policies never wait, so this function behaves the same as `offer()`.
+    ///
+    bool tryOffer(Element element)
+    {
+        return this->insert(false, std::move(element));
+    }
+
+    ///
+    /// Remove the head of the queue without waiting
+    ///
+    /// @return The head element on success, `std::nullopt` if the queue is empty.
+    /// @note Only the consumer thread may call this function.
+    ///
+    std::optional<Element> tryPoll()
+    {
+        std::optional<Element> element;
+
+        // Skip the slots whose elements have been delivered by slots in other queues that share the mailboxes
+        do
+        {
+            element = this->pollSlot();
+        }
+        while (element && !this->collect(*element));
+
+        return element;
+    }
+
+    ///
+    /// Remove the head of the queue
+    ///
+    /// @return The head element.
+    /// @note Only the consumer thread may call this function.
+    ///
+    Element poll()
+    {
+        while (true)
+        {
+            auto element = this->pollWithTimeout(std::chrono::nanoseconds(-1));
+
+            if (element)
+            {
+                return std::move(*element);
+            }
+        }
+    }
+
+    ///
+    /// Remove all available elements without waiting and append them to the given container
+    ///
+    /// @param container A container that supports `push_back`
+    /// @param maxCount The maximum number of elements to remove
+    /// @return The number of elements removed.
+    /// @note Only the consumer thread may call this function.
+    ///
+    template <typename Container>
+    size_t drainTo(Container& container, size_t maxCount = SIZE_MAX)
+    {
+        size_t count = 0;
+
+        while (count < maxCount)
+        {
+            auto element = this->tryPoll();
+
+            if (!element)
+            {
+                break;
+            }
+
+            container.push_back(std::move(*element));
+
+            count += 1;
+        }
+
+        return count;
+    }
+
+    ///
+    /// Wait up to the specified amount of time to retrieve the head element and remove it from the queue
+    ///
+    /// @param timeout The amount of time to wait until the queue is non-empty, or a negative value to wait indefinitely
+    /// @return The head element on success, `std::nullopt` on timed out.
+    /// @note Only the consumer thread may call this function.
+    ///
+    template <typename Representation, typename Period>
+    std::optional<Element> pollWithTimeout(const std::chrono::duration<Representation, Period>& timeout)
+    {
+        // Fast path: The queue is not empty
+        if (auto element = this->tryPoll())
+        {
+            return element;
+        }
+
+        if (timeout.count() == 0)
+        {
+            return std::nullopt;
+        }
+
+        auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(timeout);
+
+        auto deadline = std::chrono::steady_clock::now() + duration;
+
+        while (true)
+        {
+            // Announce that the consumer is about to sleep and check the queue again
+            uint32_t ticket = this->wakeup->nonempty.load();
+
+            this->wakeup->sleeping.store(true, std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            if (auto element = this->tryPoll())
+            {
+                this->wakeup->sleeping.store(false, std::memory_order_relaxed);
+
+                return element;
+            }
+
+            if (duration.count() < 0)
+            {
+                this->wakeup->nonempty.wait(ticket);
+            }
+            else
+            {
+                auto remaining = deadline - std::chrono::steady_clock::now();
+
+                if (remaining.count() <= 0)
+                {
+                    this->wakeup->sleeping.store(false, std::memory_order_relaxed);
+
+                    return std::nullopt;
+                }
+
+                this->wakeup->nonempty.wait(ticket, std::chrono::duration_cast<std::chrono::nanoseconds>(remaining));
+            }
+
+            this->wakeup->sleeping.store(false, std::memory_order_relaxed);
+
+            if (auto element = this->tryPoll())
+            {
+                return element;
+            }
+        }
+    }
+};
+
+#endif /* MPSCRingQueue_hpp */
@@ -0,0 +1,151 @@
+//
+//  Reactor.hpp
+//  Controller
+//
+//  Created by FireWolf on 10/15/26.
+//
+
+#ifndef Reactor_hpp
+#define Reactor_hpp
+
+#include "StreamSocket.hpp"
+
+#if __has_include(<sys/epoll.h>)
+    #include <sys/epoll.h>
+    #define REACTOR_AVAILABLE 1
+#else
+    #define REACTOR_AVAILABLE 0
+#endif
+
+#if REACTOR_AVAILABLE
+
+/// An event loop that multiplexes a set of descriptors with epoll
+struct Reactor
+{
+private:
+    /// The epoll descriptor managed by this class
+    int descriptor;
+
+    //
+    // MARK: - Constructor & Destructor
+    //
+
+public:
+    ///
+    /// Create an empty reactor
+    ///
+    /// @throws SocketException if failed to create the epoll instance.
+    ///
+    Reactor()
+    {
+        this->descriptor = epoll_create1(EPOLL_CLOEXEC);
+
+        if (this->descriptor < 0)
+        {
+            throw SocketException("Failed to create the epoll instance. Reason: {}.", strerror(errno));
+        }
+    }
+
+    /// The copy constructor is not available
+    Reactor(const Reactor& other) = delete;
+
+    /// The move constructor transfers the ownership of the epoll descriptor
+    Reactor(Reactor&& other) noexcept : descriptor(other.descriptor)
+    {
+        other.descriptor = -1;
+    }
+
+    ///
+    /// Release the reactor
+    ///
+    /// @note Descriptors registered with the reactor are not closed.
+    ///
+    ~Reactor()
+    {
+        if (this->descriptor >= 0)
+        {
+            close(this->descriptor);
+        }
+    }
+
+    /// Copy assignment is not available
+    Reactor& operator=(const Reactor& other) = delete;
+
+    /// Move assignment is not available
+    Reactor& operator=(Reactor&& other) = delete;
+
+    //
+    // MARK: - Manage Descriptors
+    //
+
+    ///
+    /// Start monitoring the given descriptor for incoming data
+    ///
+    /// @param descriptor A descriptor to monitor
+    /// @param token An opaque value passed to the event handler when the descriptor becomes readable
+    /// @return `true` on success, `false` otherwise.
+    /// @note The descriptor is monitored in level-triggered mode,
+    ///       so a handler that does not consume all available data is invoked again on the next iteration.
+    ///
+    bool add(int descriptor, uint64_t token)
+    {
+        epoll_event event = {};
+
+        event.events = EPOLLIN | EPOLLRDHUP;
+
+        event.data.u64 = token;
+
+        return epoll_ctl(this->descriptor, EPOLL_CTL_ADD, descriptor, &event) == 0;
+    }
+
+    ///
+    /// Stop monitoring the given descriptor
+    ///
+    /// @param descriptor A descriptor previously added to the reactor
+    /// @return `true` on success, `false` otherwise.
+    ///
+    bool remove(int descriptor)
+    {
+        return epoll_ctl(this->descriptor, EPOLL_CTL_DEL, descriptor, nullptr) == 0;
+    }
+
+    //
+    // MARK: - Run Loop
+    //
+
+    ///
+    /// Wait for events and dispatch them to the given handler
+    ///
+    /// @param handler A callable object invoked as `handler(token, events)` for each ready descriptor
+    /// @param timeout The maximum amount of time in milliseconds to wait, or -1 to wait indefinitely
+    /// @return The number of events dispatched, or -1 on error.
+    ///
+    template <typename Handler>
+    requires std::invocable<Handler, uint64_t, uint32_t>
+    int poll(Handler&& handler, int timeout = -1)
+    {
+        epoll_event events[32];
+
+        int count = epoll_wait(this->descriptor, events, std::size(events), timeout);
+
+        if (count < 0)
+        {
+            return errno == EINTR ? 0 : -1;
+        }
+
+        for (int index = 0; index < count; index += 1)
+        {
+            uint64_t token = events[index].data.u64;
+
+            uint32_t flags = events[index].events;
+
+            std::invoke(handler, token, flags);
+        }
+
+        return count;
+    }
+};
+
+#endif /* REACTOR_AVAILABLE */
+
+#endif /* Reactor_hpp */
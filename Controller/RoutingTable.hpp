@@ -0,0 +1,423 @@
+//
+//  RoutingTable.hpp
+//  Controller
+//
+//  Created by FireWolf on 10/15/26.
+//
+
+#ifndef RoutingTable_hpp
+#define RoutingTable_hpp
+
+#include "Message.hpp"
+#include "DeviceRegistry.hpp"
+#include "Debug.hpp"
+#include <array>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <optional>
+#include <algorithm>
+#include <bit>
+#include <strings.h>
+
+///
+/// A set of rules that map a source device and a message type to the devices to which the message is relayed
+///
+/// @tparam Role Specify the type of device roles
+/// @note Each rule has the form `<source> <type> [<destination>...]` where
+///       the source and each destination is `*` for all devices, a role name such as `actuator` or a device identifier,
+///       and the type is a message type number or name such as `SoilDryAlert`.
+///       A rule without destinations accepts the message without relaying it.
+///       For each source device and message type, rules that name the device override rules that name its role,
+///       which in turn override rules that use `*`; rules at the same level accumulate their destinations.
+///       The rules are compiled once for each source device, but destinations are resolved whenever a message is relayed.
+///
+template <typename Role>
+struct RoutingTable
+{
+public:
+    /// The number of message types
+    static constexpr size_t kTypeCount = Message::Type::kRunOutOfWaterAlert + 1;
+
+    /// Specifies which devices a rule refers to
+    struct Selector
+    {
+        /// Kinds of selectors in the order of increasing precedence
+        enum Kind
+        {
+            /// All devices
+            kAny,
+
+            /// All devices of a role
+            kRole,
+
+            /// A single device
+            kDevice,
+        };
+
+        /// The kind of the selector
+        Kind kind;
+
+        /// The role if the selector is `kRole` or the device identifier if the selector is `kDevice`
+        size_t value;
+    };
+
+    /// A rule in the table
+    struct Rule
+    {
+        /// The devices from which the message is received
+        Selector source;
+
+        /// The type of the message
+        Message::Type type;
+
+        /// The devices to which the message is relayed
+        std::vector<Selector> destinations;
+    };
+
+    /// The routing decision for a message type received from a device
+    /// @note Destinations are resolved against the registry whenever a message is relayed,
+    ///       so devices attached later receive the messages without recompiling the routes.
+    struct Route
+    {
+        /// `true` if the message type is expected from the device, `false` otherwise
+        bool accepted = false;
+
+        /// `true` if the message is relayed to all devices
+        bool any = false;
+
+        /// The set of roles to whose devices the message is relayed, one bit per role
+        uint64_t roles = 0;
+
+        /// Identifiers of other devices to which the message is relayed
+        std::vector<DeviceID> devices = {};
+    };
+
+    /// Routing decisions for a source device indexed by the message type
+    using Routes = std::array<Route, kTypeCount>;
+
+private:
+    /// Rules in the order they are specified
+    std::vector<Rule> rules;
+
+    ///
+    /// Parse a selector
+    ///
+    /// @param token `*`, a role name or a device identifier
+    /// @param roleCount The number of roles
+    /// @param role2String A function that returns the name of a role
+    /// @return The selector on success, `std::nullopt` if the given token is invalid.
+    ///
+    template <typename RoleNamer>
+    static std::optional<Selector> parseSelector(const std::string& token, size_t roleCount, RoleNamer&& role2String)
+    {
+        if (token == "*")
+        {
+            return Selector{ Selector::kAny, 0 };
+        }
+
+        for (size_t role = 0; role < roleCount; role += 1)
+        {
+            if (strcasecmp(token.c_str(), role2String(static_cast<Role>(role))) == 0)
+            {
+                return Selector{ Selector::kRole, role };
+            }
+        }
+
+        char* end = nullptr;
+
+        unsigned long identifier = strtoul(token.c_str(), &end, 10);
+
+        if (token.empty() || *end != '\0' || identifier > UINT32_MAX)
+        {
+            return std::nullopt;
+        }
+
+        return Selector{ Selector::kDevice, identifier };
+    }
+
+    ///
+    /// Parse a message type
+    ///
+    /// @param token A message type number or name without spaces, e.g. `5` or `SoilDryAlert`
+    /// @return The message type on success, `std::nullopt` if the given token is invalid.
+    ///
+    static std::optional<Message::Type> parseType(const std::string& token)
+    {
+        for (size_t type = 0; type < kTypeCount; type += 1)
+        {
+            std::string name = Message::Type2String(static_cast<Message::Type>(type));
+
+            name.erase(std::remove(name.begin(), name.end(), ' '), name.end());
+
+            if (strcasecmp(token.c_str(), name.c_str()) == 0)
+            {
+                return static_cast<Message::Type>(type);
+            }
+        }
+
+        char* end = nullptr;
+
+        unsigned long type = strtoul(token.c_str(), &end, 10);
+
+        if (token.empty() || *end != '\0' || type >= kTypeCount)
+        {
+            return std::nullopt;
+        }
+
+        return static_cast<Message::Type>(type);
+    }
+
+    ///
+    /// Check whether the given selector refers to the given device
+    ///
+    /// @param selector A selector
+    /// @param identifier The device identifier
+    /// @param role The role of the device
+    /// @return `true` if the selector refers to the device, `false` otherwise.
+    ///
+    static bool matches(const Selector& selector, DeviceID identifier, Role role)
+    {
+        switch (selector.kind)
+        {
+            case Selector::kAny:
+                return true;
+
+            case Selector::kRole:
+                return selector.value == static_cast<size_t>(role);
+
+            case Selector::kDevice:
+                return selector.value == identifier;
+        }
+
+        return false;
+    }
+
+public:
+    ///
+    /// Add a rule to the table
+    ///
+    /// @param source The devices from which the message is received
+    /// @param type The type of the message
+    /// @param destinations The devices to which the message is relayed
+    ///
+    void add(Selector source, Message::Type type, std::vector<Selector> destinations = {})
+    {
+        this->rules.push_back({ source, type, std::move(destinations) });
+    }
+
+    ///
+    /// Parse the routing table from the given stream
+    ///
+    /// @param stream A stream that contains one rule per line; Text after `#` is ignored
+    /// @param roleCount The number of roles
+    /// @param role2String A function that returns the name of a role
+    /// @return The routing table on success, `std::nullopt` if any rule is malformed.
+    ///
+    template <typename RoleNamer>
+    static std::optional<RoutingTable> parse(std::istream& stream, size_t roleCount, RoleNamer&& role2String)
+    {
+        RoutingTable table;
+
+        std::string line;
+
+        for (size_t number = 1; std::getline(stream, line); number += 1)
+        {
+            std::istringstream tokens(line.substr(0, line.find('#')));
+
+            std::string sourceToken, typeToken, destinationToken;
+
+            // Guard: Skip empty lines
+            if (!(tokens >> sourceToken))
+            {
+                continue;
+            }
+
+            auto source = parseSelector(sourceToken, roleCount, role2String);
+
+            if (!source)
+            {
+                perr("Line %zu: Invalid source device: %s.", number, sourceToken.c_str());
+
+                return std::nullopt;
+            }
+
+            if (!(tokens >> typeToken))
+            {
+                perr("Line %zu: Missing the message type.", number);
+
+                return std::nullopt;
+            }
+
+            auto type = parseType(typeToken);
+
+            if (!type)
+            {
+                perr("Line %zu: Invalid message type: %s.", number, typeToken.c_str());
+
+                return std::nullopt;
+            }
+
+            std::vector<Selector> destinations;
+
+            while (tokens >> destinationToken)
+            {
+                auto destination = parseSelector(destinationToken, roleCount, role2String);
+
+                if (!destination)
+                {
+                    perr("Line %zu: Invalid destination device: %s.", number, destinationToken.c_str());
+
+                    return std::nullopt;
+                }
+
+                destinations.push_back(*destination);
+            }
+
+            table.add(*source, *type, std::move(destinations));
+        }
+
+        return table;
+    }
+
+    ///
+    /// Load the routing table from the given file
+    ///
+    /// @param path The path of the file
+    /// @param roleCount The number of roles
+    /// @param role2String A function that returns the name of a role
+    /// @return The routing table on success, `std::nullopt` if the file cannot be read or any rule is malformed.
+    ///
+    template <typename RoleNamer>
+    static std::optional<RoutingTable> load(const std::string& path, size_t roleCount, RoleNamer&& role2String)
+    {
+        std::ifstream stream(path);
+
+        if (!stream)
+        {
+            perr("Failed to open the routing table %s.", path.c_str());
+
+            return std::nullopt;
+        }
+
+        return parse(stream, roleCount, std::forward<RoleNamer>(role2String));
+    }
+
+    ///
+    /// Resolve the rules for the given source device
+    ///
+    /// @param source The identifier of the source device
+    /// @param role The role of the source device
+    /// @return Routing decisions indexed by the message type.
+    ///
+    [[nodiscard]]
+    Routes compile(DeviceID source, Role role) const
+    {
+        Routes routes;
+
+        for (size_t type = 0; type < kTypeCount; type += 1)
+        {
+            Route& route = routes[type];
+
+            // Find the most specific level of rules that apply to the source device
+            std::optional<typename Selector::Kind> level;
+
+            for (const Rule& rule : this->rules)
+            {
+                if (rule.type == type && matches(rule.source, source, role) && (!level || rule.source.kind > *level))
+                {
+                    level = rule.source.kind;
+                }
+            }
+
+            if (!level)
+            {
+                continue;
+            }
+
+            route.accepted = true;
+
+            // Collect the destinations of all rules at that level
+            for (const Rule& rule : this->rules)
+            {
+                if (rule.type != type || rule.source.kind != *level || !matches(rule.source, source, role))
+                {
+                    continue;
+                }
+
+                for (const Selector& destination : rule.destinations)
+                {
+                    switch (destination.kind)
+                    {
+                        case Selector::kAny:
+                            route.any = true;
+
+                            break;
+
+                        case Selector::kRole:
+                            route.roles |= uint64_t{1} << destination.value;
+
+                            break;
+
+                        case Selector::kDevice:
+                            if (std::find(route.devices.begin(), route.devices.end(), destination.value) == route.devices.end())
+                            {
+                                route.devices.push_back(static_cast<DeviceID>(destination.value));
+                            }
+
+                            break;
+                    }
+                }
+            }
+        }
+
+        return routes;
+    }
+
+    ///
+    /// Invoke the given handler on each device to which a message is relayed
+    ///
+    /// @param route The routing decision for the message
+    /// @param devices The registry of devices, each of which exposes its `identifier` and `role`
+    /// @param source The identifier of the device from which the message is received
+    /// @param handler A callable object invoked as `handler(device)` for each destination device exactly once
+    /// @note A message is never relayed back to the device from which it is received.
+    ///
+    template <typename Registry, typename Handler>
+    static void forEachDestination(const Route& route, const Registry& devices, DeviceID source, Handler&& handler)
+    {
+        auto relay = [&](auto& device) -> void
+        {
+            if (device.identifier != source)
+            {
+                handler(device);
+            }
+        };
+
+        if (route.any)
+        {
+            devices.forEach(relay);
+
+            return;
+        }
+
+        for (uint64_t roles = route.roles; roles != 0; roles &= roles - 1)
+        {
+            devices.forEach(static_cast<Role>(std::countr_zero(roles)), relay);
+        }
+
+        for (DeviceID identifier : route.devices)
+        {
+            auto* device = devices.get(identifier);
+
+            // Guard: Skip devices that do not exist yet or that have been visited by their role
+            if (device != nullptr && (route.roles >> static_cast<size_t>(device->role) & 1) == 0)
+            {
+                relay(*device);
+            }
+        }
+    }
+};
+
+#endif /* RoutingTable_hpp */
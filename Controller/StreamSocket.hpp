@@ -13,15 +13,42 @@
 #include <unistd.h>
 #include <arpa/inet.h>
 #include <netinet/in.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <climits>
 #include <exception>
 #include <string>
 #include <fmt/format.h>
 #include <cerrno>
+#include <cstring>
 #include <optional>
 
 using SocketAddress4 = std::pair<in_addr_t, in_port_t>;
 using SocketAddress6 = std::pair<in6_addr, in_port_t>;
 
+/// The path of a Unix domain socket
+struct SocketAddressUnix
+{
+    std::string path;
+};
+
+/// The path of a terminal device along with the raw mode read parameters
+struct SerialPortAddress
+{
+    /// The path of the terminal device, e.g. `/dev/pts/3`
+    std::string path;
+
+    /// The minimum number of bytes returned by a read (VMIN)
+    cc_t vmin;
+
+    /// The inter-byte timeout in tenths of a second (VTIME)
+    cc_t vtime;
+};
+
 struct SocketException: std::exception
 {
     std::string message;
@@ -49,6 +76,17 @@ struct SocketAddressConverter
     {
         return { .sin6_family = AF_INET6, .sin6_port = htons(address.second), .sin6_addr = address.first };
     }
+
+    sockaddr_un operator()(const SocketAddressUnix& address)
+    {
+        sockaddr_un result = {};
+
+        result.sun_family = AF_UNIX;
+
+        strncpy(result.sun_path, address.path.c_str(), sizeof(result.sun_path) - 1);
+
+        return result;
+    }
 };
 
 struct SocketAddressPrinter
@@ -72,14 +110,60 @@ struct SocketAddressPrinter
 
         return fmt::format("{}:{}", buffer, address.second);
     }
+
+    std::string operator()(const SocketAddressUnix& address)
+    {
+        return fmt::format("unix:{}", address.path);
+    }
+
+    std::string operator()(const SerialPortAddress& address)
+    {
+        return fmt::format("tty:{}", address.path);
+    }
 };
 
+///
+/// A connected byte stream to an emulated device
+///
+/// @note The descriptor refers to a stream socket (TCP or Unix domain) or to a terminal device in raw mode.
+///       All of them are accessed via `read(2)` and `write(2)`, so they share the same send and receive paths.
+///
 struct StreamSocket
 {
 private:
+    /// Listening sockets create stream sockets from accepted descriptors
+    friend struct ListeningSocket;
+
     /// The socket descriptor managed by this class
     int descriptor;
 
+    ///
+    /// Check whether the last operation failed because the descriptor is non-blocking and not ready
+    ///
+    /// @return `true` if the caller should retry the operation, `false` otherwise.
+    /// @note The function hints the processor that the caller is spinning before it returns `true`.
+    ///
+    static inline bool shouldRetry()
+    {
+        if (errno == EINTR)
+        {
+            return true;
+        }
+
+        if (errno != EAGAIN && errno != EWOULDBLOCK)
+        {
+            return false;
+        }
+
+    #if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+    #elif defined(__aarch64__) || defined(__arm__)
+        asm volatile("yield");
+    #endif
+
+        return true;
+    }
+
     //
     // MARK: - Constructor & Destructor
     //
@@ -99,6 +183,7 @@ private:
     /// @param domain Pass `PF_INET` for IPv4 domain or `PF_INET6` for IPv6 domain
     /// @param local The socket address on the local machine
     /// @param remote The socket address on the remote machine
+    /// @param blocking Pass `false` to return as soon as the connection is initiated
     /// @throws SocketException if failed to create the socket descriptor;
     ///                         if failed to bind the socket to the given local address;
     ///                         if failed to connect the socket to the given remote address.
@@ -106,7 +191,7 @@ private:
     ///
     template <typename SocketAddress>
     requires std::same_as<SocketAddress, SocketAddress4> || std::same_as<SocketAddress, SocketAddress6>
-    StreamSocket(int domain, SocketAddress local, SocketAddress remote)
+    StreamSocket(int domain, SocketAddress local, SocketAddress remote, bool blocking)
     {
         // Guard: Create a socket descriptor
         this->descriptor = socket(domain, SOCK_STREAM, 0);
@@ -116,6 +201,14 @@ private:
             throw SocketException("Failed to create a socket descriptor.");
         }
 
+        // Guard: Initiate the connection without waiting for it if requested
+        if (!blocking && !this->setBlocking(false))
+        {
+            close(this->descriptor);
+
+            throw SocketException("Failed to put the socket into non-blocking mode. Reason: {}.", strerror(errno));
+        }
+
         // Guard: Bind the socket to the given local address
         auto laddr = SocketAddressConverter{}(local);
 
@@ -130,7 +223,7 @@ private:
         // Guard: Connect the socket to the given remote address
         auto raddr = SocketAddressConverter{}(remote);
 
-        if (connect(this->descriptor, reinterpret_cast<sockaddr*>(&raddr), sizeof(raddr)) != 0)
+        if (connect(this->descriptor, reinterpret_cast<sockaddr*>(&raddr), sizeof(raddr)) != 0 && (blocking || errno != EINPROGRESS))
         {
             close(this->descriptor);
 
@@ -145,22 +238,122 @@ public:
     ///
     /// @param local The socket address on the local machine
     /// @param remote The socket address on the remote machine
+    /// @param blocking Pass `false` to return as soon as the connection is initiated
     /// @throws SocketException if failed to create the socket descriptor;
     ///                         if failed to bind the socket to the given local address;
     ///                         if failed to connect the socket to the given remote address.
+    /// @note If `blocking` is `false`, the socket is non-blocking and becomes writable once the connection completes or fails;
+    ///       Call `getPendingError()` to find out which.
     ///
-    StreamSocket(SocketAddress4 local, SocketAddress4 remote) : StreamSocket(PF_INET, local, remote) {}
+    StreamSocket(SocketAddress4 local, SocketAddress4 remote, bool blocking = true) : StreamSocket(PF_INET, local, remote, blocking) {}
 
     ///
     /// Create a stream socket with the given IPv6 socket addresses
     ///
     /// @param local The socket address on the local machine
     /// @param remote The socket address on the remote machine
+    /// @param blocking Pass `false` to return as soon as the connection is initiated
     /// @throws SocketException if failed to create the socket descriptor;
     ///                         if failed to bind the socket to the given local address;
     ///                         if failed to connect the socket to the given remote address.
+    /// @note If `blocking` is `false`, the socket is non-blocking and becomes writable once the connection completes or fails;
+    ///       Call `getPendingError()` to find out which.
+    ///
+    StreamSocket(SocketAddress6 local, SocketAddress6 remote, bool blocking = true) : StreamSocket(PF_INET6, local, remote, blocking) {}
+
+    ///
+    /// Create a stream socket connected to the given Unix domain socket
+    ///
+    /// @param remote The path of the Unix domain socket on the local machine
+    /// @param blocking Pass `false` to return as soon as the connection is initiated
+    /// @throws SocketException if the path is too long;
+    ///                         if failed to create the socket descriptor;
+    ///                         if failed to connect the socket to the given path.
+    /// @note If `blocking` is `false`, the socket is non-blocking and becomes writable once the connection completes or fails;
+    ///       Call `getPendingError()` to find out which.
+    ///
+    explicit StreamSocket(const SocketAddressUnix& remote, bool blocking = true)
+    {
+        // Guard: The path must fit in the socket address
+        if (remote.path.size() >= sizeof(sockaddr_un::sun_path))
+        {
+            throw SocketException("The path of the Unix domain socket {} is too long.", remote.path);
+        }
+
+        // Guard: Create a socket descriptor
+        this->descriptor = socket(PF_UNIX, SOCK_STREAM, 0);
+
+        if (this->descriptor < 0)
+        {
+            throw SocketException("Failed to create a socket descriptor.");
+        }
+
+        // Guard: Initiate the connection without waiting for it if requested
+        if (!blocking && !this->setBlocking(false))
+        {
+            close(this->descriptor);
+
+            throw SocketException("Failed to put the socket into non-blocking mode. Reason: {}.", strerror(errno));
+        }
+
+        // Guard: Connect the socket to the given path
+        auto raddr = SocketAddressConverter{}(remote);
+
+        if (connect(this->descriptor, reinterpret_cast<sockaddr*>(&raddr), sizeof(raddr)) != 0 && (blocking || errno != EINPROGRESS))
+        {
+            close(this->descriptor);
+
+            throw SocketException("Failed to connect the socket to {}. Reason: {}.",
+                                  SocketAddressPrinter{}(remote), strerror(errno));
+        }
+    }
+
     ///
-    StreamSocket(SocketAddress6 local, SocketAddress6 remote) : StreamSocket(PF_INET6, local, remote) {}
+    /// Open the given terminal device and put it into raw mode
+    ///
+    /// @param address The path of the terminal device and the raw mode read parameters
+    /// @throws SocketException if failed to open the terminal device;
+    ///                         if the path does not refer to a terminal device;
+    ///                         if failed to configure the terminal device.
+    /// @note A read returns once at least `vmin` bytes are available or the inter-byte timer `vtime` expires,
+    ///       so bursts of data are delivered in batches rather than one byte at a time.
+    ///
+    explicit StreamSocket(const SerialPortAddress& address)
+    {
+        // Guard: Open the terminal device
+        this->descriptor = open(address.path.c_str(), O_RDWR | O_NOCTTY | O_CLOEXEC);
+
+        if (this->descriptor < 0)
+        {
+            throw SocketException("Failed to open {}. Reason: {}.", SocketAddressPrinter{}(address), strerror(errno));
+        }
+
+        // Guard: The device must be a terminal
+        termios attributes = {};
+
+        if (tcgetattr(this->descriptor, &attributes) != 0)
+        {
+            close(this->descriptor);
+
+            throw SocketException("Failed to get the attributes of {}. Reason: {}.", SocketAddressPrinter{}(address), strerror(errno));
+        }
+
+        // Guard: Switch to the raw mode
+        cfmakeraw(&attributes);
+
+        attributes.c_cflag |= CLOCAL | CREAD;
+
+        attributes.c_cc[VMIN] = address.vmin;
+
+        attributes.c_cc[VTIME] = address.vtime;
+
+        if (tcsetattr(this->descriptor, TCSANOW, &attributes) != 0)
+        {
+            close(this->descriptor);
+
+            throw SocketException("Failed to put {} into raw mode. Reason: {}.", SocketAddressPrinter{}(address), strerror(errno));
+        }
+    }
 
     /// The copy constructor is not available
     StreamSocket(const StreamSocket& other) = delete;
@@ -187,11 +380,16 @@ public:
     /// Copy assignment is not available
     StreamSocket& operator=(const StreamSocket& other) = delete;
 
-    /// Move assignment transfers the ownership of the socket descriptor
+    /// Move assignment closes the managed socket descriptor and transfers the ownership of the other one
     StreamSocket& operator=(StreamSocket&& other) noexcept
     {
         if (this != &other)
         {
+            if (this->descriptor >= 0)
+            {
+                close(this->descriptor);
+            }
+
             this->descriptor = other.descriptor;
 
             other.descriptor = -1;
@@ -200,6 +398,151 @@ public:
         return *this;
     }
 
+    //
+    // MARK: - Query Properties
+    //
+
+    ///
+    /// Get the socket descriptor managed by this class
+    ///
+    /// @return The socket descriptor.
+    /// @note The ownership of the descriptor is not transferred to the caller.
+    ///
+    [[nodiscard]]
+    inline int getDescriptor() const
+    {
+        return this->descriptor;
+    }
+
+    ///
+    /// Check whether the managed descriptor refers to a socket
+    ///
+    /// @return `true` if the descriptor is a socket, `false` if it is a terminal device.
+    ///
+    [[nodiscard]]
+    inline bool isSocket() const
+    {
+        struct stat status = {};
+
+        return fstat(this->descriptor, &status) == 0 && S_ISSOCK(status.st_mode);
+    }
+
+    ///
+    /// Get the result of a non-blocking connect
+    ///
+    /// @return Zero if the connection is established, otherwise the error number that describes why the connection failed.
+    /// @note The error is cleared once it is retrieved.
+    ///       A terminal device is never pending, so the function always returns zero for it.
+    ///
+    [[nodiscard]]
+    int getPendingError() const
+    {
+        if (!this->isSocket())
+        {
+            return 0;
+        }
+
+        int error = 0;
+
+        socklen_t length = sizeof(error);
+
+        if (getsockopt(this->descriptor, SOL_SOCKET, SO_ERROR, &error, &length) != 0)
+        {
+            return errno;
+        }
+
+        return error;
+    }
+
+    //
+    // MARK: - Configure the Socket
+    //
+
+    ///
+    /// Switch the descriptor between the blocking and non-blocking modes
+    ///
+    /// @param blocking Pass `true` to let operations wait until they can proceed,
+    ///                 `false` to let operations fail with `EAGAIN` if they cannot proceed immediately
+    /// @return `true` on success, `false` otherwise.
+    ///
+    bool setBlocking(bool blocking) const
+    {
+        int flags = fcntl(this->descriptor, F_GETFL);
+
+        if (flags < 0)
+        {
+            return false;
+        }
+
+        flags = blocking ? (flags & ~O_NONBLOCK) : (flags | O_NONBLOCK);
+
+        return fcntl(this->descriptor, F_SETFL, flags) == 0;
+    }
+
+    ///
+    /// Enable or disable busy polling
+    ///
+    /// @param enabled Pass `true` to put the descriptor into non-blocking mode so that all operations spin until they can proceed,
+    ///                `false` to restore the blocking mode
+    /// @return `true` on success, `false` otherwise.
+    /// @note On Linux, the function also asks the kernel to busy poll the device queue on behalf of a socket (`SO_BUSY_POLL`).
+    ///       This is best-effort, because raising the busy poll timeout may require privileges and
+    ///       only network devices that support busy polling honor it.
+    ///
+    bool setBusyPolling(bool enabled) const
+    {
+        if (!this->setBlocking(!enabled))
+        {
+            return false;
+        }
+
+    #if defined(SO_BUSY_POLL)
+        if (this->isSocket())
+        {
+            int microseconds = enabled ? 50 : 0;
+
+            setsockopt(this->descriptor, SOL_SOCKET, SO_BUSY_POLL, &microseconds, sizeof(microseconds));
+        }
+    #endif
+
+        return true;
+    }
+
+    ///
+    /// Replace the connection behind the managed descriptor with the given one
+    ///
+    /// @param other A stream socket connected to the same device, which is closed on return
+    /// @return `true` on success, `false` otherwise.
+    /// @note The descriptor number does not change, so threads that cache it keep working on the new connection.
+    ///       The status flags are those of the given socket, so busy polling must be enabled again if needed.
+    ///
+    bool replace(StreamSocket other)
+    {
+        int result;
+
+        do
+        {
+            result = dup2(other.descriptor, this->descriptor);
+        }
+        while (result < 0 && errno == EINTR);
+
+        return result >= 0;
+    }
+
+    ///
+    /// Shut down both directions of the connection
+    ///
+    /// @note Threads that are blocked on the socket return immediately, but the descriptor remains open.
+    ///       The function has no effect on a terminal device.
+    ///
+    void shutdown() const
+    {
+        if (this->isSocket())
+        {
+            ::shutdown(this->descriptor, SHUT_RDWR);
+        }
+    }
+
     //
     // MARK: - Socket Communication
     //
@@ -210,12 +553,79 @@ public:
     /// @param data The data to send
     /// @param length The number of bytes to sent
     /// @return `true` if the operation completes successfully, `false` otherwise.
+    /// @note The caller remains blocked until all bytes are sent, even if the kernel accepts them partially.
     ///
     inline bool send(const void* data, size_t length) const
     {
-        ssize_t result = ::send(this->descriptor, data, length, 0);
+        size_t offset = 0;
+
+        while (offset < length)
+        {
+            ssize_t result = write(this->descriptor, reinterpret_cast<const uint8_t*>(data) + offset, length - offset);
+
+            if (result < 0)
+            {
+                if (shouldRetry())
+                {
+                    continue;
+                }
+
+                return false;
+            }
+
+            offset += static_cast<size_t>(result);
+        }
+
+        return true;
+    }
+
+    ///
+    /// Send the data described by the given vectors to the remote host with as few system calls as possible
+    ///
+    /// @param vectors A non-null array of vectors that describe the data to send
+    /// @param count The number of vectors
+    /// @return `true` if the operation completes successfully, `false` otherwise.
+    /// @note The caller remains blocked until all bytes are sent, even if the kernel accepts them partially.
+    /// @warning The given vectors are modified to skip the bytes that have been sent.
+    ///
+    inline bool sendWithVectors(iovec* vectors, size_t count) const
+    {
+        while (count > 0)
+        {
+            ssize_t result = writev(this->descriptor, vectors, static_cast<int>(std::min<size_t>(count, IOV_MAX)));
+
+            if (result < 0)
+            {
+                if (shouldRetry())
+                {
+                    continue;
+                }
+
+                return false;
+            }
+
+            // Skip the vectors that have been sent completely
+            auto sent = static_cast<size_t>(result);
+
+            while (count > 0 && sent >= vectors->iov_len)
+            {
+                sent -= vectors->iov_len;
+
+                vectors += 1;
 
-        return result >= 0 && static_cast<size_t>(result) == length;
+                count -= 1;
+            }
+
+            // Skip the bytes that have been sent partially
+            if (sent > 0)
+            {
+                vectors->iov_base = reinterpret_cast<uint8_t*>(vectors->iov_base) + sent;
+
+                vectors->iov_len -= sent;
+            }
+        }
+
+        return true;
     }
 
     ///
@@ -240,7 +650,13 @@ public:
     ///
     inline bool receive(void* data, size_t& length) const
     {
-        ssize_t result = recv(this->descriptor, data, length, 0);
+        ssize_t result;
+
+        do
+        {
+            result = read(this->descriptor, data, length);
+        }
+        while (result < 0 && shouldRetry());
 
         if (result <= 0)
         {
@@ -259,6 +675,7 @@ public:
     /// @param length The number of bytes to receive from the remote host
     /// @return `true` on success, `false` otherwise.
     /// @note This caller remains blocked until the designated number of bytes is received from the remote host.
+    ///       The caller spins instead if busy polling is enabled.
     ///
     inline bool receiveWithLength(void* data, size_t length) const
     {
@@ -266,7 +683,12 @@ public:
 
         while (offset < length)
         {
-            ssize_t result = recv(this->descriptor, reinterpret_cast<uint8_t*>(data) + offset, length - offset, 0);
+            ssize_t result = read(this->descriptor, reinterpret_cast<uint8_t*>(data) + offset, length - offset);
+
+            if (result < 0 && shouldRetry())
+            {
+                continue;
+            }
 
             if (result <= 0)
             {
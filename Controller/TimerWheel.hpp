@@ -0,0 +1,489 @@
+//
+//  TimerWheel.hpp
+//  Controller
+//
+//  Created by FireWolf on 10/16/26.
+//
+
+#ifndef TimerWheel_hpp
+#define TimerWheel_hpp
+
+#include <array>
+#include <vector>
+#include <optional>
+#include <algorithm>
+#include <utility>
+#include <bit>
+#include <cstdint>
+#include <cstddef>
+
+/// Identifies a timer scheduled on a timer wheel
+using TimerID = uint64_t;
+
+///
+/// A hierarchical timer wheel that schedules one-shot and periodic timers
+///
+/// @tparam Payload Specify the type of the value delivered when a timer fires
+/// @note Time is measured in ticks chosen by the caller.
+///       The wheel has 4 levels of 64 slots, so a timer within 64^4 ticks of the current tick is filed in O(1),
+///       and a timer further away waits in the last slot of the top level until it comes within reach.
+///       Each level keeps a bitmap of its non-empty slots, so the next tick at which work is due is found in O(1).
+///       Timers are stored in a pool and linked into slots by index, so scheduling and cancelling never allocate once the pool has grown.
+///       The wheel is not thread-safe.
+///
+template <typename Payload>
+struct TimerWheel
+{
+private:
+    /// The number of bits of a tick consumed by each level
+    static constexpr size_t kSlotBits = 6;
+
+    /// The number of slots in each level
+    static constexpr size_t kSlotCount = size_t{1} << kSlotBits;
+
+    /// The mask that maps a tick to a slot of a level
+    static constexpr uint64_t kSlotMask = kSlotCount - 1;
+
+    /// The number of levels
+    static constexpr size_t kLevelCount = 4;
+
+    /// The index that marks the end of a list
+    static constexpr uint32_t kNil = UINT32_MAX;
+
+    /// A timer in the pool
+    struct Node
+    {
+        /// The tick at which the timer fires next
+        uint64_t expiry;
+
+        /// The number of ticks between two firings, or 0 for a one-shot timer
+        uint64_t period;
+
+        /// The previous and the next timer in the same slot
+        uint32_t previous, next;
+
+        /// The level and the slot in which the timer is filed
+        uint16_t level, slot;
+
+        /// The number of times the node has been reused, which makes stale identifiers harmless
+        uint32_t generation;
+
+        /// `true` if the node holds a scheduled timer
+        bool active;
+
+        /// The value delivered when the timer fires
+        std::optional<Payload> payload;
+    };
+
+    /// The pool of timers
+    std::vector<Node> nodes;
+
+    /// Indices of unused nodes in the pool
+    std::vector<uint32_t> freeNodes;
+
+    /// The first timer in each slot of each level
+    std::array<std::array<uint32_t, kSlotCount>, kLevelCount> heads;
+
+    /// The non-empty slots of each level
+    std::array<uint64_t, kLevelCount> occupied;
+
+    /// The last tick processed by the wheel
+    uint64_t current;
+
+    /// The number of scheduled timers
+    size_t count;
+
+    /// The timers that fire at the tick being processed
+    std::vector<uint32_t> due;
+
+    ///
+    /// File the given timer in the slot that matches its expiry
+    ///
+    /// @param index The index of an active timer that is not in any slot
+    ///
+    void file(uint32_t index)
+    {
+        Node& node = this->nodes[index];
+
+        uint64_t delta = node.expiry - this->current;
+
+        size_t level = 0;
+
+        while (level + 1 < kLevelCount && delta >= (uint64_t{1} << (kSlotBits * (level + 1))))
+        {
+            level += 1;
+        }
+
+        // A timer beyond the reach of the top level waits in the slot that is cascaded last
+        uint64_t tick = delta >= (uint64_t{1} << (kSlotBits * kLevelCount)) ? this->current + (uint64_t{1} << (kSlotBits * kLevelCount)) - 1 : node.expiry;
+
+        auto slot = static_cast<uint16_t>((tick >> (kSlotBits * level)) & kSlotMask);
+
+        node.level = static_cast<uint16_t>(level);
+
+        node.slot = slot;
+
+        node.previous = kNil;
+
+        node.next = this->heads[level][slot];
+
+        if (node.next != kNil)
+        {
+            this->nodes[node.next].previous = index;
+        }
+
+        this->heads[level][slot] = index;
+
+        this->occupied[level] |= uint64_t{1} << slot;
+    }
+
+    ///
+    /// Remove the given timer from its slot
+    ///
+    /// @param index The index of a timer filed in a slot
+    ///
+    void unlink(uint32_t index)
+    {
+        Node& node = this->nodes[index];
+
+        if (node.previous != kNil)
+        {
+            this->nodes[node.previous].next = node.next;
+        }
+        else
+        {
+            this->heads[node.level][node.slot] = node.next;
+        }
+
+        if (node.next != kNil)
+        {
+            this->nodes[node.next].previous = node.previous;
+        }
+
+        if (this->heads[node.level][node.slot] == kNil)
+        {
+            this->occupied[node.level] &= ~(uint64_t{1} << node.slot);
+        }
+    }
+
+    ///
+    /// Detach all timers in the given slot
+    ///
+    /// @param level The level of the slot
+    /// @param slot The index of the slot
+    /// @return The index of the first timer in the detached list.
+    ///
+    uint32_t detach(size_t level, size_t slot)
+    {
+        uint32_t head = this->heads[level][slot];
+
+        this->heads[level][slot] = kNil;
+
+        this->occupied[level] &= ~(uint64_t{1} << slot);
+
+        return head;
+    }
+
+    ///
+    /// Release the given timer back to the pool
+    ///
+    /// @param index The index of a timer that is not in any slot
+    ///
+    void release(uint32_t index)
+    {
+        Node& node = this->nodes[index];
+
+        node.active = false;
+
+        node.payload.reset();
+
+        node.generation += 1;
+
+        this->freeNodes.push_back(index);
+
+        this->count -= 1;
+    }
+
+    ///
+    /// Move the timers of the higher levels whose slot is reached by the current tick down to the lower levels
+    ///
+    void cascade()
+    {
+        for (size_t level = 1; level < kLevelCount; level += 1)
+        {
+            // Guard: The current tick has not wrapped around the lower level
+            if (((this->current >> (kSlotBits * (level - 1))) & kSlotMask) != 0)
+            {
+                break;
+            }
+
+            for (uint32_t index = this->detach(level, (this->current >> (kSlotBits * level)) & kSlotMask); index != kNil;)
+            {
+                uint32_t next = this->nodes[index].next;
+
+                this->file(index);
+
+                index = next;
+            }
+        }
+    }
+
+    //
+    // MARK: - Constructor & Destructor
+    //
+
+public:
+    ///
+    /// Create an empty timer wheel
+    ///
+    /// @param start The tick from which the wheel starts
+    ///
+    explicit TimerWheel(uint64_t start = 0) : current(start), count(0)
+    {
+        for (auto& level : this->heads)
+        {
+            level.fill(kNil);
+        }
+
+        this->occupied.fill(0);
+    }
+
+    //
+    // MARK: - Query Properties
+    //
+
+    ///
+    /// Get the number of scheduled timers
+    ///
+    /// @return The number of timers that will fire at least once more.
+    ///
+    [[nodiscard]]
+    size_t getCount() const
+    {
+        return this->count;
+    }
+
+    ///
+    /// Get the last tick processed by the wheel
+    ///
+    /// @return The current tick.
+    ///
+    [[nodiscard]]
+    uint64_t getCurrentTick() const
+    {
+        return this->current;
+    }
+
+    ///
+    /// Get the next tick at which the wheel has work to do
+    ///
+    /// @return The tick at which a timer fires or timers are moved to a lower level, `std::nullopt` if no timer is scheduled.
+    /// @note The caller should advance the wheel to the returned tick and ask again.
+    ///
+    [[nodiscard]]
+    std::optional<uint64_t> getNextTick() const
+    {
+        if (this->count == 0)
+        {
+            return std::nullopt;
+        }
+
+        // Timers in the higher levels are moved down once the lowest level wraps around
+        uint64_t boundary = ((this->current >> kSlotBits) + 1) << kSlotBits;
+
+        // A timer in the lowest level fires within the next 64 ticks
+        uint64_t next = this->current + 1;
+
+        uint64_t pending = std::rotr(this->occupied[0], static_cast<int>(next & kSlotMask));
+
+        if (pending == 0)
+        {
+            return boundary;
+        }
+
+        next += static_cast<uint64_t>(std::countr_zero(pending));
+
+        for (size_t level = 1; level < kLevelCount; level += 1)
+        {
+            if (this->occupied[level] != 0)
+            {
+                return std::min(next, boundary);
+            }
+        }
+
+        return next;
+    }
+
+    ///
+    /// Check whether the given timer is scheduled
+    ///
+    /// @param identifier The identifier of a timer
+    /// @return `true` if the timer will fire at least once more, `false` otherwise.
+    ///
+    [[nodiscard]]
+    bool isScheduled(TimerID identifier) const
+    {
+        auto index = static_cast<uint32_t>(identifier);
+
+        return index < this->nodes.size() && this->nodes[index].active && this->nodes[index].generation == static_cast<uint32_t>(identifier >> 32);
+    }
+
+    ///
+    /// Visit all scheduled timers
+    ///
+    /// @param handler A callable object that takes the identifier, the expiry, the period and a constant reference to the payload of each timer
+    ///
+    template <typename Handler>
+    void forEach(Handler&& handler) const
+    {
+        for (size_t index = 0; index < this->nodes.size(); index += 1)
+        {
+            const Node& node = this->nodes[index];
+
+            if (node.active)
+            {
+                handler(static_cast<TimerID>(node.generation) << 32 | index, node.expiry, node.period, *node.payload);
+            }
+        }
+    }
+
+    //
+    // MARK: - Manage Timers
+    //
+
+    ///
+    /// Schedule a timer
+    ///
+    /// @param expiry The tick at which the timer fires for the first time
+    /// @param period The number of ticks between two firings, or 0 for a one-shot timer
+    /// @param payload The value delivered each time the timer fires
+    /// @return The identifier of the timer.
+    /// @note A timer whose expiry is not after the current tick fires at the next tick.
+    ///
+    TimerID schedule(uint64_t expiry, uint64_t period, Payload payload)
+    {
+        uint32_t index;
+
+        if (this->freeNodes.empty())
+        {
+            index = static_cast<uint32_t>(this->nodes.size());
+
+            this->nodes.push_back({});
+        }
+        else
+        {
+            index = this->freeNodes.back();
+
+            this->freeNodes.pop_back();
+        }
+
+        Node& node = this->nodes[index];
+
+        node.expiry = std::max(expiry, this->current + 1);
+
+        node.period = period;
+
+        node.active = true;
+
+        node.payload.emplace(std::move(payload));
+
+        this->count += 1;
+
+        this->file(index);
+
+        return static_cast<TimerID>(node.generation) << 32 | index;
+    }
+
+    ///
+    /// Cancel a timer
+    ///
+    /// @param identifier The identifier of the timer
+    /// @return `true` on success, `false` if the timer has already fired for the last time or has been cancelled.
+    ///
+    bool cancel(TimerID identifier)
+    {
+        if (!this->isScheduled(identifier))
+        {
+            return false;
+        }
+
+        auto index = static_cast<uint32_t>(identifier);
+
+        this->unlink(index);
+
+        this->release(index);
+
+        return true;
+    }
+
+    ///
+    /// Process all ticks up to the given one and fire the timers that expire on the way
+    ///
+    /// @param tick The current tick
+    /// @param handler A callable object that takes the identifier and a constant reference to the payload of each timer that fires
+    /// @return The number of periodic firings skipped because the wheel was advanced too late to fire them on time.
+    /// @note A periodic timer is rescheduled relative to its previous expiry, so it does not drift.
+    ///       The handler must not schedule or cancel timers.
+    ///
+    template <typename Handler>
+    uint64_t advance(uint64_t tick, Handler&& handler)
+    {
+        uint64_t skipped = 0;
+
+        while (this->current < tick)
+        {
+            // Jump over the ticks at which nothing happens
+            auto next = this->getNextTick();
+
+            if (!next || *next > tick)
+            {
+                this->current = tick;
+
+                break;
+            }
+
+            this->current = *next;
+
+            this->cascade();
+
+            this->due.clear();
+
+            for (uint32_t index = this->detach(0, this->current & kSlotMask); index != kNil; index = this->nodes[index].next)
+            {
+                this->due.push_back(index);
+            }
+
+            for (uint32_t index : this->due)
+            {
+                Node& node = this->nodes[index];
+
+                handler(static_cast<TimerID>(node.generation) << 32 | index, std::as_const(*node.payload));
+
+                if (node.period == 0)
+                {
+                    this->release(index);
+
+                    continue;
+                }
+
+                // Skip the firings that are already late
+                node.expiry += node.period;
+
+                if (node.expiry <= tick)
+                {
+                    uint64_t missed = (tick - node.expiry) / node.period + 1;
+
+                    node.expiry += missed * node.period;
+
+                    skipped += missed;
+                }
+
+                this->file(index);
+            }
+        }
+
+        return skipped;
+    }
+};
+
+#endif /* TimerWheel_hpp */
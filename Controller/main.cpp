@@ -10,7 +10,10 @@
 //
 
 #include <getopt.h>
+#include <csignal>
 #include "Controller.hpp"
+#include "Endpoint.hpp"
+#include "Connector.hpp"
 #include "Debug.hpp"
 
 int main(int argc, const char * argv[])
@@ -21,15 +24,29 @@ int main(int argc, const char * argv[])
         { "moisture", optional_argument, nullptr, 'm' },
         { "actuator", optional_argument, nullptr, 'a' },
         { "gateway" , optional_argument, nullptr, 'g' },
+        { "listen"  , required_argument, nullptr, 'l' },
+        { "reactor" , no_argument, nullptr, 'r' },
+        { "transport", required_argument, nullptr, 't' },
+        { "routes", required_argument, nullptr, 'R' },
+        { "lanes", required_argument, nullptr, 'L' },
         { nullptr, no_argument, nullptr, 0 },
     };
 
-    // Parsed port numbers
-    uint16_t pMonitor = 0, pActuator = 0, pGateway = 0;
+    // Parsed endpoints along with the role of each device in the order specified by the user
+    std::vector<std::pair<Controller::Role, Endpoint>> endpoints;
+
+    // Parsed listening endpoints along with the role of accepted devices, if specified by the user
+    std::vector<std::pair<std::optional<Controller::Role>, Endpoint>> listeners;
+
+    // Parsed controller options
+    Controller::Options controllerOptions = { .reactor = false, .transport = Controller::kBlocking };
+
+    // Parsed routing table
+    Controller::Router routingTable = Controller::makeDefaultRoutingTable();
 
     while (true)
     {
-        int option = getopt_long(argc, const_cast<char**>(argv), "m:a:g:", options, nullptr);
+        int option = getopt_long(argc, const_cast<char**>(argv), "m:a:g:l:rt:R:L:", options, nullptr);
 
         if (option == -1)
         {
@@ -40,22 +57,127 @@ int main(int argc, const char * argv[])
         switch (option)
         {
             case 'm':
+            case 'a':
+            case 'g':
             {
-                pMonitor = std::stoi(optarg);
+                auto endpoint = Endpoint::parse(optarg);
+
+                if (!endpoint)
+                {
+                    perr("Invalid endpoint: %s.", optarg);
+
+                    return -1;
+                }
+
+                auto role = option == 'm' ? Controller::kMonitor : (option == 'a' ? Controller::kActuator : Controller::kGateway);
+
+                endpoints.emplace_back(role, *endpoint);
 
                 break;
             }
 
-            case 'a':
+            case 'l':
+            {
+                // An optional prefix fixes the role of accepted devices, otherwise each device identifies itself
+                static const std::pair<const char*, Controller::Role> kPrefixes[] =
+                {
+                    { "monitor:", Controller::kMonitor },
+                    { "actuator:", Controller::kActuator },
+                    { "gateway:", Controller::kGateway },
+                };
+
+                std::string argument = optarg;
+
+                std::optional<Controller::Role> role = std::nullopt;
+
+                for (const auto& [prefix, candidate] : kPrefixes)
+                {
+                    if (argument.starts_with(prefix))
+                    {
+                        argument.erase(0, strlen(prefix));
+
+                        role = candidate;
+                    }
+                }
+
+                auto endpoint = Endpoint::parse(argument);
+
+                if (!endpoint || endpoint->kind == Endpoint::kTerminal)
+                {
+                    perr("Invalid listening endpoint: %s.", optarg);
+
+                    return -1;
+                }
+
+                listeners.emplace_back(role, *endpoint);
+
+                break;
+            }
+
+            case 'r':
             {
-                pActuator = std::stoi(optarg);
+            #if REACTOR_AVAILABLE
+                controllerOptions.reactor = true;
+            #else
+                pwarning("The reactor is not supported on this platform. Will use one receiver thread per device.");
+            #endif
 
                 break;
             }
 
-            case 'g':
+            case 't':
+            {
+                if (strcmp(optarg, "io_uring") == 0)
+                {
+                #if IOURING_AVAILABLE
+                    if (IOURing::isSupported())
+                    {
+                        controllerOptions.transport = Controller::kIOURing;
+                    }
+                    else
+                    {
+                        pwarning("The kernel does not support the io_uring features used by the controller, which require Linux 6.0. Will use the blocking transport.");
+                    }
+                #else
+                    pwarning("The io_uring transport is not supported on this platform. Will use the blocking transport.");
+                #endif
+                }
+                else if (strcmp(optarg, "blocking") != 0)
+                {
+                    perr("Unrecognized transport: %s.", optarg);
+                }
+
+                break;
+            }
+
+            case 'R':
             {
-                pGateway = std::stoi(optarg);
+                auto table = Controller::Router::load(optarg, Controller::kRoleCount, Controller::Role2String);
+
+                if (!table)
+                {
+                    perr("Invalid routing table: %s.", optarg);
+
+                    return -1;
+                }
+
+                routingTable = std::move(*table);
+
+                break;
+            }
+
+            case 'L':
+            {
+                auto lanes = LaneOptions::parse(optarg);
+
+                if (!lanes)
+                {
+                    perr("Invalid lane scheduling: %s.", optarg);
+
+                    return -1;
+                }
+
+                controllerOptions.lanes = std::move(*lanes);
 
                 break;
             }
@@ -74,44 +196,97 @@ int main(int argc, const char * argv[])
         }
     }
 
-    // Guard: Users must provide at least one port number
-    if ((pMonitor | pActuator | pGateway) == 0)
+    // Guard: Users must provide at least one endpoint
+    if (endpoints.empty() && listeners.empty())
     {
-        perr("Must provide at least one port number.");
+        perr("Must provide at least one port number or socket path.");
 
         return -1;
     }
 
-    // Create sockets to communicate with devices
-    std::optional<StreamSocket> monitor, actuator, gateway;
+    // Writing to a device that has gone away fails with `EPIPE` instead of terminating the controller
+    signal(SIGPIPE, SIG_IGN);
+
+    Controller controller(controllerOptions, std::move(routingTable));
 
-    try
+    // Listen for devices that connect to the controller
+    for (const auto& [role, endpoint] : listeners)
     {
-        // Create the TCP socket to communicate with the moisture device
-        if (pMonitor != 0)
+        try
         {
-            monitor.emplace(std::make_pair(INADDR_LOOPBACK, 0), std::make_pair(INADDR_LOOPBACK, pMonitor));
+            controller.addListener(role, endpoint);
         }
+        catch (SocketException& exception)
+        {
+            perr("%s", exception.what());
+
+            return -1;
+        }
+
+        pinfo("Listening for %s devices on %s.", role ? Controller::Role2String(*role) : "all", endpoint.description().c_str());
+    }
+
+    // Connect to all devices and receive their preambles concurrently
+    std::vector<Endpoint> addresses;
+
+    for (const auto& [role, endpoint] : endpoints)
+    {
+        addresses.push_back(endpoint);
+    }
 
-        // Create the TCP socket to communicate with the actuator device
-        if (pActuator != 0)
+    auto attempts = Connector::connect(addresses);
+
+    // Register each device with the controller
+    std::chrono::nanoseconds elapsed = {};
+
+    size_t ready = 0;
+
+    for (size_t index = 0; index < endpoints.size(); index += 1)
+    {
+        const auto& [role, endpoint] = endpoints[index];
+
+        auto& attempt = attempts[index];
+
+        const char* name = Controller::Role2String(role);
+
+        // Guard: The controller cannot function without all devices
+        if (attempt.stage == Connector::kFailed)
         {
-            actuator.emplace(std::make_pair(INADDR_LOOPBACK, 0), std::make_pair(INADDR_LOOPBACK, pActuator));
+            perr("%s", attempt.error.c_str());
+
+            return -1;
         }
 
-        // Create the TCP socket to communicate with the gateway device
-        if (pGateway != 0)
+        auto identifier = controller.addDevice(role, endpoint, std::move(*attempt.socket), { .spin = endpoint.spin, .cpu = endpoint.cpu, .dropOffline = endpoint.dropOffline, .queue = endpoint.queue });
+
+        if (!identifier)
         {
-            gateway.emplace(std::make_pair(INADDR_LOOPBACK, 0), std::make_pair(INADDR_LOOPBACK, pGateway));
+            perr("Failed to add the %s device at %s. Reason: Too many devices.", name, endpoint.description().c_str());
+
+            return -1;
         }
-    }
-    catch (SocketException& exception)
-    {
-        perr("%s", exception.what());
 
-        return -1;
+        if (attempt.stage == Connector::kIncomplete)
+        {
+            pwarning("Failed to receive the preamble from the %s device #%u. Reason: %s.", name, *identifier, attempt.error.c_str());
+
+            pwarning("The controller may not function properly.");
+
+            continue;
+        }
+
+        elapsed = std::max(elapsed, attempt.readyTime);
+
+        ready += 1;
+
+        pinfo("Connected to the %s device #%u at %s in %.3f ms and received the preamble in %.3f ms.",
+              name, *identifier, endpoint.description().c_str(),
+              std::chrono::duration<double, std::milli>(attempt.connectTime).count(),
+              std::chrono::duration<double, std::milli>(attempt.readyTime).count());
     }
 
-    // Create the controller and run it
-    return Controller(std::move(monitor), std::move(actuator), std::move(gateway)).run();
+    printf("%zu of %zu devices are ready in %.3f ms.\n", ready, endpoints.size(), std::chrono::duration<double, std::milli>(elapsed).count());
+
+    // Run the controller
+    return controller.run();
 }
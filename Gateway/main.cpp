@@ -0,0 +1,328 @@
+//
+//  main.cpp
+//  Gateway
+//
+//  Created by FireWolf on 10/16/26.
+//
+
+#include <getopt.h>
+#include <poll.h>
+#include <csignal>
+#include <chrono>
+#include <vector>
+#include "Endpoint.hpp"
+#include "CoAP.hpp"
+#include "Debug.hpp"
+
+/// The size of a CoAP request message sent by the controller, which the gateway kernel reads in one piece
+static constexpr size_t kRequestSize = 32;
+
+/// The maximum number of requests translated from a single receive
+static constexpr size_t kMaxBatchSize = 1024;
+
+/// The maximum size of an HTTP request message translated from a CoAP request message
+/// @note The host, the path and the payload all come from the 32-byte request, so the message cannot grow much beyond the fixed text.
+static constexpr size_t kMaxReplySize = 128;
+
+/// The preamble sent on each connection, as the ARM FastModels does before the serial port carries any data
+static constexpr char kPreamble[] = "Gateway Ready\r\n";
+
+static_assert(sizeof(kPreamble) - 1 == 15, "The controller expects a 15-byte preamble.");
+
+///
+/// Translate a CoAP request message to an HTTP request message as the gateway kernel does
+///
+/// @param request The CoAP request message in the legacy header layout
+/// @param buffer A non-null buffer that stores the HTTP request message on return
+/// @return The size of the HTTP request message on success, `std::nullopt` if the request is malformed or its method is not GET, POST or PUT.
+/// @note The URI-Path options are joined by slashes unless they already begin with one, and the port defaults to 5683 if the request does not have the URI-Port option.
+///
+static std::optional<size_t> translate(std::span<const uint8_t, kRequestSize> request, uint8_t (&buffer)[kMaxReplySize])
+{
+    auto message = CoAPMessageView::decode(request, kLegacy);
+
+    // The CoAP method codes 0.01, 0.02 and 0.03 have the same values as the HTTP methods
+    if (!message || message->header.code < CoAPCode(0, kGet) || message->header.code > CoAPCode(0, kPut))
+    {
+        return std::nullopt;
+    }
+
+    // The host and the path must be null-terminated, and both fit in the buffer because the request is smaller
+    char host[kRequestSize + 1] = {}, path[kRequestSize + 1] = {};
+
+    size_t length = 0;
+
+    uint16_t port = 5683;
+
+    for (const CoAPOptionView& option : *message)
+    {
+        switch (option.number)
+        {
+            case kURIHost:
+            {
+                memcpy(host, option.value.data(), option.value.size());
+
+                break;
+            }
+
+            case kURIPort:
+            {
+                port = 0;
+
+                for (uint8_t byte : option.value)
+                {
+                    port = static_cast<uint16_t>(port << 8 | byte);
+                }
+
+                break;
+            }
+
+            case kURIPath:
+            {
+                // The controller sends the whole path with its leading slash as a single option
+                if (option.value.empty() || option.value.front() != '/')
+                {
+                    path[length++] = '/';
+                }
+
+                memcpy(path + length, option.value.data(), option.value.size());
+
+                length += option.value.size();
+
+                break;
+            }
+
+            default:
+            {
+                break;
+            }
+        }
+    }
+
+    if (length == 0)
+    {
+        path[0] = '/';
+    }
+
+    return HTTPMessageCreate(buffer, sizeof(buffer), static_cast<HTTPMethod>(message->header.code), host, port, path, message->payload.data(), message->payload.size());
+}
+
+///
+/// Pin the calling thread to the given processor
+///
+/// @param cpu The index of the processor
+///
+static void pinThread(uint32_t cpu)
+{
+#if defined(__linux__)
+    cpu_set_t set;
+
+    CPU_ZERO(&set);
+
+    CPU_SET(cpu, &set);
+
+    int result = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+
+    if (result != 0)
+    {
+        pwarning("Failed to pin the gateway to CPU %u. Reason: %s.", cpu, strerror(result));
+    }
+#else
+    pwarning("Thread pinning is not supported on this platform. The gateway is not pinned to CPU %u.", cpu);
+#endif
+}
+
+///
+/// Translate the requests sent by the controller until it disconnects
+///
+/// @param socket A socket connected to the controller
+/// @param delay The amount of time spent on each request to emulate the processing time of the gateway kernel
+/// @return The number of requests translated.
+/// @note All complete requests that arrive in a single receive are translated and replied to with a single send.
+///
+static size_t serve(const StreamSocket& socket, std::chrono::nanoseconds delay)
+{
+    using Clock = std::chrono::steady_clock;
+
+    std::vector<uint8_t> requests(kRequestSize * kMaxBatchSize);
+
+    std::vector<uint8_t> replies(kMaxReplySize * kMaxBatchSize);
+
+    // The number of bytes of a partial request at the beginning of the request buffer
+    size_t pending = 0;
+
+    size_t translated = 0;
+
+    while (true)
+    {
+        size_t length = requests.size() - pending;
+
+        if (!socket.receive(requests.data() + pending, length))
+        {
+            return translated;
+        }
+
+        length += pending;
+
+        size_t offset = 0, produced = 0;
+
+        for (; offset + kRequestSize <= length; offset += kRequestSize)
+        {
+            // Emulate the processing time
+            for (auto deadline = Clock::now() + delay; delay.count() > 0 && Clock::now() < deadline;) {}
+
+            uint8_t reply[kMaxReplySize];
+
+            auto size = translate(std::span<const uint8_t, kRequestSize>(requests.data() + offset, kRequestSize), reply);
+
+            if (!size)
+            {
+                pwarning("Dropped a malformed CoAP request message.");
+
+                continue;
+            }
+
+            memcpy(replies.data() + produced, reply, *size);
+
+            produced += *size;
+
+            translated += 1;
+        }
+
+        // Keep the partial request for the next receive
+        pending = length - offset;
+
+        memmove(requests.data(), requests.data() + offset, pending);
+
+        if (produced > 0 && !socket.send(replies.data(), produced))
+        {
+            return translated;
+        }
+    }
+}
+
+int main(int argc, const char * argv[])
+{
+    // Command line options
+    static option options[] =
+    {
+        { "delay", required_argument, nullptr, 'd' },
+        { nullptr, no_argument, nullptr, 0 },
+    };
+
+    std::chrono::nanoseconds delay = {};
+
+    while (true)
+    {
+        int option = getopt_long(argc, const_cast<char**>(argv), "d:", options, nullptr);
+
+        if (option == -1)
+        {
+            // Finished parsing
+            break;
+        }
+
+        if (option != 'd')
+        {
+            return -1;
+        }
+
+        char* end = nullptr;
+
+        delay = std::chrono::nanoseconds(strtoull(optarg, &end, 10));
+
+        if (*optarg == '\0' || *end != '\0')
+        {
+            printf("Invalid delay: %s.\n", optarg);
+
+            return -1;
+        }
+    }
+
+    // Guard: Users must provide exactly one endpoint
+    auto endpoint = optind + 1 == argc ? Endpoint::parse(argv[optind]) : std::nullopt;
+
+    if (!endpoint || endpoint->kind == Endpoint::kTerminal)
+    {
+        printf("Usage: %s [-d <NANOSECONDS>] <PORT|unix:PATH>[,spin][,cpu=<N>]\n", argv[0]);
+
+        return -1;
+    }
+
+    // Writing to a controller that has gone away fails with `EPIPE` instead of terminating the gateway
+    signal(SIGPIPE, SIG_IGN);
+
+    if (endpoint->cpu)
+    {
+        pinThread(*endpoint->cpu);
+    }
+
+    std::optional<ListeningSocket> listener;
+
+    try
+    {
+        listener.emplace(endpoint->listen());
+    }
+    catch (SocketException& exception)
+    {
+        printf("%s\n", exception.what());
+
+        return -1;
+    }
+
+    printf("Gateway is listening on %s.\n", endpoint->description().c_str());
+
+    // Serve one controller at a time, as the serial port of an emulated board does
+    while (true)
+    {
+        pollfd descriptor = { .fd = listener->getDescriptor(), .events = POLLIN, .revents = 0 };
+
+        if (poll(&descriptor, 1, -1) < 0)
+        {
+            continue;
+        }
+
+        auto socket = [&]() -> std::optional<StreamSocket>
+        {
+            try
+            {
+                return listener->accept();
+            }
+            catch (SocketException& exception)
+            {
+                pwarning("%s", exception.what());
+
+                return std::nullopt;
+            }
+        }();
+
+        if (!socket)
+        {
+            continue;
+        }
+
+        // The socket is non-blocking after being accepted, which is what spinning needs
+        if (!endpoint->spin && !socket->setBlocking(true))
+        {
+            pwarning("Failed to put the connection into blocking mode. Reason: %s.", strerror(errno));
+
+            continue;
+        }
+
+        if (!socket->send(kPreamble, sizeof(kPreamble) - 1))
+        {
+            continue;
+        }
+
+        printf("The controller is connected.\n");
+
+        auto start = std::chrono::steady_clock::now();
+
+        size_t translated = serve(*socket, delay);
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        printf("The controller is disconnected after %zu requests in %.3f seconds (%.2f requests per second).\n",
+               translated, elapsed.count(), static_cast<double>(translated) / elapsed.count());
+    }
+}